@@ -0,0 +1,81 @@
+/* bench_binarise.cpp – histogram two-means vs the old per-pixel k-means
+ *
+ *   bench_binarise.exe <frames_dir> [repeat]
+ *
+ * frames_dir: any .png/.bmp/.jpg (e.g. temp/debug_capture_*.png saved with
+ * debug_img=true). Times detail::binarise against detail::binarise_kmeans
+ * and reports how many mask pixels agree. k-means numbers its clusters
+ * arbitrarily, so agreement is taken up to polarity.                      */
+#include "dlog.hpp"
+#include "dscreen_ocr.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+int main(int argc, char** argv)
+{
+    SetConsoleOutputCP(CP_UTF8);
+    std::setlocale(LC_ALL, ".UTF8");
+
+    if (argc < 2) {
+        LOG_ERROR("usage: %s <frames_dir> [repeat]\n", argv[0]);
+        return 1;
+    }
+    const int repeat = argc > 2 ? std::max(1, std::atoi(argv[2])) : 1;
+
+    std::vector<cv::Mat> imgs;
+    for (const auto& e : fs::directory_iterator(argv[1])) {
+        std::string ext = e.path().extension().string();
+        if (ext != ".png" && ext != ".bmp" && ext != ".jpg") continue;
+        cv::Mat m = cv::imread(e.path().string(), cv::IMREAD_UNCHANGED);
+        if (m.empty()) continue;
+        if (m.channels() == 3) cv::cvtColor(m, m, cv::COLOR_BGR2BGRA);   // frames are BGRA
+        if (m.channels() == 4) imgs.push_back(m);
+    }
+    if (imgs.empty()) {
+        LOG_ERROR("no images in %s\n", argv[1]);
+        return 1;
+    }
+    LOG_INFO("%zu frames, %d repeat(s)\n", imgs.size(), repeat);
+
+    auto time = [&](cv::Mat (*fn)(const cv::Mat&), std::vector<cv::Mat>& out) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeat; ++r) {
+            out.clear();
+            for (const cv::Mat& m : imgs) out.push_back(fn(m));
+        }
+        std::chrono::duration<double> d = std::chrono::steady_clock::now() - t0;
+        return 1000.0 * d.count() / (double(imgs.size()) * repeat);
+    };
+
+    std::vector<cv::Mat> ref, hist;
+    const double ms_ref  = time(&so::detail::binarise_kmeans, ref);
+    const double ms_hist = time(&so::detail::binarise, hist);
+
+    size_t same_skip = 0, px = 0, agree = 0;
+    double worst = 1.0;
+    for (size_t i = 0; i < imgs.size(); ++i) {
+        const bool sa = ref[i].channels() != 1, sb = hist[i].channels() != 1;   // guard: image returned
+        if (sa != sb) { LOG_WARN("frame %zu: threshold guard differs\n", i); worst = 0; continue; }
+        ++same_skip;
+        if (sa) continue;
+        const size_t n  = ref[i].total();
+        size_t eq = 0;
+        for (int y = 0; y < ref[i].rows; ++y) {
+            const uint8_t* a = ref[i].ptr(y);
+            const uint8_t* b = hist[i].ptr(y);
+            for (int x = 0; x < ref[i].cols; ++x) eq += a[x] == b[x];
+        }
+        const size_t a  = std::max(eq, n - eq);
+        px += n; agree += a;
+        worst = std::min(worst, double(a) / n);
+    }
+
+    std::printf("kmeans     %8.2f ms/frame\n", ms_ref);
+    std::printf("histogram  %8.2f ms/frame   x%.1f\n", ms_hist, ms_ref / ms_hist);
+    std::printf("guard agrees on %zu/%zu frames, mask agreement %.3f%% (worst frame %.3f%%)\n",
+                same_skip, imgs.size(), px ? 100.0 * agree / px : 100.0, 100.0 * worst);
+    return 0;
+}
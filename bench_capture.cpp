@@ -0,0 +1,80 @@
+/* bench_capture.cpp – captures per second: one-shot GDI vs capture context vs capture thread */
+#include "dlog.hpp"
+#include "dwin_api.hpp"
+#include "dscreen_ocr.hpp"
+#include <chrono>
+#include <cstdlib>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/* run `fn` n times, report captures/s */
+template <class Fn>
+double bench(const char* label, int n, Fn&& fn)
+{
+    fn();                                       // warm-up (allocations, DIB sections)
+    auto t0 = Clock::now();
+    for (int i = 0; i < n; ++i) fn();
+    std::chrono::duration<double> d = Clock::now() - t0;
+    double cps = n / d.count();
+    LOG_INFO("%-34s %6d captures in %8.3f s  →  %8.1f captures/s  (%.3f ms each)\n",
+             label, n, d.count(), cps, 1000.0 * d.count() / n);
+    return cps;
+}
+
+} // anonym-ns
+
+int main(int argc, char** argv)
+{
+    SetConsoleOutputCP(CP_UTF8);
+    std::setlocale(LC_ALL, ".UTF8");
+    SetProcessDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2);
+
+    const int n = argc > 1 ? std::atoi(argv[1]) : 200;
+    std::string window_label = CFG_STR("window", "......");
+
+    HWND hwnd = dw::find_window_utf8(window_label, true);
+    if (!hwnd) {
+        LOG_ERROR("Window not found\n");
+        return 1;
+    }
+    LOG_INFO("Hooked window: %s\n", dw::get_window_title(hwnd).c_str());
+
+    RECT rc{}; ::GetClientRect(hwnd, &rc);
+    LOG_INFO("Client area %ldx%ld, %d iterations per case\n", rc.right, rc.bottom, n);
+
+    /* full client area */
+    double before = bench("full  | one-shot GDI + GetDIBits", n, [&]{
+        cv::Mat m = so::detail::capture(hwnd, true);
+    });
+    double after  = bench("full  | DIB-section context", n, [&]{
+        dw::Capture cap = dw::capture_context(hwnd).grab();
+    });
+    LOG_INFO("full-frame speed-up: x%.2f\n", after / before);
+
+    /* one 220x40 price cell, as the scraping procs read it */
+    const RECT cell{1220, 742, 1440, 782};
+    double crop = bench("roi   | one-shot full grab + crop", n, [&]{
+        cv::Mat m = so::detail::capture(hwnd, true);
+        cv::Mat r = m(so::detail::to_rect(cell)).clone();
+    });
+    double roi  = bench("roi   | context strip blit", n, [&]{
+        dw::Capture cap = dw::capture_context(hwnd).grab(std::vector<RECT>{cell});
+    });
+    LOG_INFO("roi speed-up: x%.2f\n", roi / crop);
+
+    /* interpreter-side cost of "a frame taken after the last input" */
+    const int fps = std::max(1, CFG_INT("capture_fps", 0) > 0 ? CFG_INT("capture_fps", 0) : 30);
+    so::CaptureThread::get().start(hwnd, fps);
+    bench("wait  | capture thread, after input", n, [&]{
+        dw::note_input();
+        so::FramePtr f = so::CaptureThread::get().after_input(dw::input_seq());
+    });
+    bench("peek  | capture thread, latest", n, [&]{
+        so::FramePtr f = so::CaptureThread::get().latest();
+    });
+    so::CaptureThread::get().stop();
+
+    return 0;
+}
@@ -0,0 +1,67 @@
+/* bench_scan.cpp – phrase-locator strategies over saved frames
+ *
+ *   bench_scan.exe <frames_dir> "<phrase>" [repeat]
+ *
+ * frames_dir: any .png/.bmp/.jpg (e.g. temp/debug_capture_*.png saved with
+ * debug_img=true). Reports images/s and hit rate for every strategy, with
+ * and without first_only.                                                  */
+#include "dlog.hpp"
+#include "dscreen_ocr.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+int main(int argc, char** argv)
+{
+    SetConsoleOutputCP(CP_UTF8);
+    std::setlocale(LC_ALL, ".UTF8");
+
+    if (argc < 3) {
+        LOG_ERROR("usage: %s <frames_dir> \"<phrase>\" [repeat]\n", argv[0]);
+        return 1;
+    }
+    const std::string query  = argv[2];
+    const int         repeat = argc > 3 ? std::max(1, std::atoi(argv[3])) : 1;
+
+    std::vector<cv::Mat> imgs;
+    for (const auto& e : fs::directory_iterator(argv[1])) {
+        std::string ext = e.path().extension().string();
+        if (ext != ".png" && ext != ".bmp" && ext != ".jpg") continue;
+        cv::Mat m = cv::imread(e.path().string(), cv::IMREAD_UNCHANGED);
+        if (!m.empty()) imgs.push_back(m);
+    }
+    if (imgs.empty()) {
+        LOG_ERROR("no images in %s\n", argv[1]);
+        return 1;
+    }
+    LOG_INFO("%zu frames, phrase '%s', %d repeat(s)\n", imgs.size(), query.c_str(), repeat);
+
+    so::Engine& eng = so::Engine::get();
+    du::set_min_level("warn");                    // keep per-word logs out of the timing
+
+    for (const so::ScanStrategy& st : so::scan_strategies()) {
+        for (bool first_only : { false, true }) {
+            so::ScanOptions opt;
+            opt.strategy   = st;
+            opt.first_only = first_only;
+
+            size_t found = 0, boxes = 0;
+            auto t0 = std::chrono::steady_clock::now();
+            for (int r = 0; r < repeat; ++r) {
+                for (const cv::Mat& m : imgs) {
+                    auto hits = eng.find(m, query, opt);
+                    boxes += hits.size();
+                    found += !hits.empty();
+                }
+            }
+            std::chrono::duration<double> d = std::chrono::steady_clock::now() - t0;
+            const double n = double(imgs.size()) * repeat;
+            std::printf("%-18s %-10s %8.2f frames/s  %7.1f ms/frame  hit rate %5.1f%%  boxes %zu\n",
+                        st.name, first_only ? "first" : "all",
+                        n / d.count(), 1000.0 * d.count() / n, 100.0 * found / n, boxes);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,111 @@
+/* drec_tool.cpp – inspect / export a session recording (builds on Linux too)
+ *
+ *   drec_tool <file.drec> info
+ *   drec_tool <file.drec> list
+ *   drec_tool <file.drec> export <dir>      every frame as <dir>/NNNNNN.ppm
+ */
+#include "drecord.hpp"
+#include <cstdlib>
+#include <string>
+
+namespace {
+
+void write_ppm(const std::string& path, const dr::Image& img)
+{
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) { LOG_ERROR("cannot write %s\n", path.c_str()); return; }
+    const dr::FrameInfo& fi = img.info;
+    std::fprintf(f, "P6\n%u %u\n255\n", fi.w, fi.h);
+    std::vector<uint8_t> rgb(size_t(fi.w) * 3);
+    for (uint32_t y = 0; y < fi.h; ++y) {
+        const uint8_t* row = img.px.data() + size_t(y) * fi.w * fi.channels;
+        for (uint32_t x = 0; x < fi.w; ++x) {           // BGR(A) → RGB
+            const uint8_t* p = row + size_t(x) * fi.channels;
+            rgb[x*3+0] = fi.channels >= 3 ? p[2] : p[0];
+            rgb[x*3+1] = fi.channels >= 3 ? p[1] : p[0];
+            rgb[x*3+2] = p[0];
+        }
+        std::fwrite(rgb.data(), 1, rgb.size(), f);
+    }
+    std::fclose(f);
+}
+
+} // anonym-ns
+
+int main(int argc, char** argv)
+{
+    if (argc < 3) {
+        std::fprintf(stderr, "usage: %s <file.drec> info|list|export <dir>\n", argv[0]);
+        return 1;
+    }
+    dr::MappedFile mf(argv[1]);
+    if (!mf) { LOG_ERROR("cannot map %s\n", argv[1]); return 1; }
+    dr::Reader rd(mf.data(), mf.size());
+    if (!rd.ok()) return 1;
+
+    const std::string cmd = argv[2];
+
+    if (cmd == "info") {
+        size_t n[6] = {};
+        uint64_t bytes[6] = {};
+        for (const dr::IndexEntry& e : rd.index()) {
+            if (e.kind < 6) { ++n[e.kind]; bytes[e.kind] += e.size; }
+        }
+        double secs = rd.count() ? rd.index().back().t_us / 1e6 : 0.0;
+        LOG_INFO("%s: %zu chunks, %.1f s, %.1f MB%s\n", argv[1], rd.count(), secs,
+                 mf.size() / 1048576.0, rd.complete() ? "" : "  (no index – cut short)");
+        for (uint32_t k = 1; k <= 4; ++k)
+            LOG_INFO("  %-8s %8zu chunks  %10.1f KB\n",
+                     dr::to_string(dr::Kind(k)), n[k], bytes[k] / 1024.0);
+    }
+    else if (cmd == "list") {
+        for (size_t i = 0; i < rd.count(); ++i) {
+            dr::Chunk c = rd.chunk(i);
+            switch (c.kind) {
+                case dr::Kind::Key:
+                case dr::Kind::Delta: {
+                    dr::FrameInfo fi = rd.info<dr::FrameInfo>(i);
+                    std::printf("%6zu %10.3f %-7s %ux%u rc=(%d,%d,%d,%d) input=%llu %u B\n",
+                                i, c.t_us / 1e6, dr::to_string(c.kind), fi.w, fi.h,
+                                fi.rc[0], fi.rc[1], fi.rc[2], fi.rc[3],
+                                (unsigned long long)fi.input_seq, c.size);
+                    break;
+                }
+                case dr::Kind::Command: {
+                    std::string_view t = rd.text(i);
+                    std::printf("%6zu %10.3f command input=%llu  %.*s\n", i, c.t_us / 1e6,
+                                (unsigned long long)rd.info<dr::CommandInfo>(i).input_seq,
+                                int(t.size()), t.data());
+                    break;
+                }
+                case dr::Kind::Ocr: {
+                    dr::OcrInfo oi = rd.ocr(i);
+                    std::string_view t = rd.text(i);
+                    std::printf("%6zu %10.3f ocr     rc=(%d,%d,%d,%d) %s  \"%.*s\"\n", i, c.t_us / 1e6,
+                                oi.rc[0], oi.rc[1], oi.rc[2], oi.rc[3], dr::to_string(dr::OcrSource(oi.source)),
+                                int(t.size()), t.data());
+                    break;
+                }
+                default: break;
+            }
+        }
+    }
+    else if (cmd == "export" && argc > 3) {
+        size_t frames = 0;
+        dr::Image img;
+        for (size_t i = 0; i < rd.count(); ++i) {
+            dr::Kind k = rd.chunk(i).kind;
+            if (k != dr::Kind::Key && k != dr::Kind::Delta) continue;
+            if (!rd.frame(i, img)) continue;
+            char name[32]; std::snprintf(name, sizeof name, "/%06zu.ppm", i);
+            write_ppm(std::string(argv[3]) + name, img);
+            ++frames;
+        }
+        LOG_INFO("exported %zu frames to %s\n", frames, argv[3]);
+    }
+    else {
+        LOG_ERROR("unknown command: %s\n", cmd.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,129 @@
+/* glyph_harvest.cpp – build the glyph atlas from session recordings
+ *
+ *   glyph_harvest <atlas> <session.drec>... --labels <json_dir>
+ *
+ * Every Tesseract OCR chunk of a recording is paired with the latest frame
+ * covering its rectangle; the crop is segmented and, when the glyph count
+ * matches the text, each glyph is added to <atlas> under its character. An
+ * existing atlas is extended. Reads of diff images (their pixels are not the
+ * frame's) and reads answered by the atlas itself are skipped.
+ *
+ * --labels (required): only trust texts that also appear as a value in the
+ * scraped .json files (e.g. data/resources/impure) – those went through a
+ * human-checked pipeline, raw OCR may not have.                            */
+#include "dglyph.hpp"
+#include "drecord.hpp"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+/* every "…" value of a flat {"key":"value",…} file */
+void collect_labels(const fs::path& dir, std::set<std::string>& out)
+{
+    for (const auto& e : fs::directory_iterator(dir)) {
+        if (e.path().extension() != ".json") continue;
+        std::ifstream in(e.path(), std::ios::binary);
+        std::string s((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        for (size_t p = 0; (p = s.find(':', p)) != std::string::npos; ++p) {
+            size_t k = s.find_last_not_of(" \t\r\n", p - 1);
+            size_t a = s.find_first_not_of(" \t\r\n", p + 1);
+            if (k == std::string::npos || s[k] != '"' || a == std::string::npos || s[a] != '"') continue;
+            size_t b = s.find('"', a + 1);
+            if (b == std::string::npos) break;
+            out.insert(s.substr(a + 1, b - a - 1));
+            p = b;
+        }
+    }
+}
+
+bool contains(const int32_t outer[4], const int32_t inner[4])
+{
+    return outer[0] <= inner[0] && outer[1] <= inner[1]
+        && outer[2] >= inner[2] && outer[3] >= inner[3];
+}
+
+} // anonym-ns
+
+int main(int argc, char** argv)
+{
+    if (argc < 3) {
+        std::fprintf(stderr, "usage: %s <atlas> <session.drec>... --labels <json_dir>\n", argv[0]);
+        return 1;
+    }
+    const std::string atlas_path = argv[1];
+    std::vector<std::string> recs;
+    std::set<std::string>    labels;
+    bool                     use_labels = false;
+    for (int i = 2; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--labels" && i + 1 < argc) { collect_labels(argv[++i], labels); use_labels = true; }
+        else recs.push_back(a);
+    }
+    if (!use_labels) {
+        LOG_ERROR("--labels <json_dir> is required: unchecked OCR text would teach the atlas its own mistakes\n");
+        return 1;
+    }
+    LOG_INFO("%zu label string(s)\n", labels.size());
+
+    so::glyph::Atlas atlas;
+    if (fs::exists(atlas_path)) atlas.load(atlas_path);
+    const size_t before = atlas.size();
+
+    size_t seen = 0, skipped = 0, unlabeled = 0, uncovered = 0, used = 0;
+    for (const std::string& path : recs) {
+        dr::MappedFile mf(path);
+        if (!mf) { LOG_ERROR("cannot map %s\n", path.c_str()); continue; }
+        dr::Reader rd(mf.data(), mf.size());
+        if (!rd.ok()) continue;
+
+        /* latest frame chunk per capture rectangle, in chunk order */
+        std::vector<size_t> frames;
+        dr::Image img;
+        for (size_t i = 0; i < rd.count(); ++i) {
+            dr::Kind k = rd.chunk(i).kind;
+            if (k == dr::Kind::Key || k == dr::Kind::Delta) {
+                dr::FrameInfo fi = rd.info<dr::FrameInfo>(i);
+                auto same = std::find_if(frames.begin(), frames.end(), [&](size_t j) {
+                    return std::memcmp(rd.info<dr::FrameInfo>(j).rc, fi.rc, sizeof fi.rc) == 0;
+                });
+                if (same != frames.end()) *same = i; else frames.push_back(i);
+                continue;
+            }
+            if (k != dr::Kind::Ocr) continue;
+            ++seen;
+
+            /* only Tesseract on frame pixels (v1 recordings: unknown, kept) */
+            dr::OcrInfo oi = rd.ocr(i);
+            const dr::OcrSource os = dr::OcrSource(oi.source);
+            if (os == dr::OcrSource::Diff || os == dr::OcrSource::Glyph) { ++skipped; continue; }
+
+            std::string text(rd.text(i));
+            while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back()))) text.pop_back();
+            if (text.empty() || !labels.count(text)) { ++unlabeled; continue; }
+
+            /* newest frame that covers the OCR rectangle */
+            size_t src = SIZE_MAX;
+            for (size_t j : frames)
+                if (contains(rd.info<dr::FrameInfo>(j).rc, oi.rc) && (src == SIZE_MAX || j > src)) src = j;
+            if (src == SIZE_MAX || !rd.frame(src, img)) { ++uncovered; continue; }
+
+            const dr::FrameInfo& fi = img.info;
+            const int x = oi.rc[0] - fi.rc[0], y = oi.rc[1] - fi.rc[1];
+            const int w = oi.rc[2] - oi.rc[0], h = oi.rc[3] - oi.rc[1];
+            const size_t stride = size_t(fi.w) * fi.channels;
+            const uint8_t* crop = img.px.data() + size_t(y) * stride + size_t(x) * fi.channels;
+            used += so::glyph::harvest(atlas, text, crop, w, h, stride, fi.channels);
+        }
+    }
+
+    LOG_INFO("%zu OCR read(s): %zu harvested, %zu diff/glyph, %zu unlabeled, %zu without frame\n",
+             seen, used, skipped, unlabeled, uncovered);
+    LOG_INFO("atlas %s: %zu -> %zu templates\n", atlas_path.c_str(), before, atlas.size());
+    return atlas.save(atlas_path) ? 0 : 1;
+}
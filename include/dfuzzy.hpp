@@ -0,0 +1,170 @@
+// dfuzzy.hpp
+#pragma once
+/*  Approximate phrase search – Myers' bit-parallel edit distance.
+ *
+ *  Patterns and text are simplified strings (du::simplify: [a-z0-9], no
+ *  spaces), so "No es posible crear este objeto" is one run of letters and
+ *  matches across OCR word boundaries. A match is any substring of the text
+ *  within `max_edits` insertions / deletions / substitutions of the pattern.
+ *
+ *  One 64-bit column word per 64 pattern characters (Hyyrö's block form),
+ *  O(ceil(m/64)·n) per pattern; start positions come from a small DP over
+ *  the few accepted end positions.
+ *
+ *  Portable: no windows.h / OpenCV.
+ */
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <algorithm>
+
+namespace so {
+namespace fuzzy {
+
+/* [begin, end) in the searched text */
+struct Match {
+    size_t begin = 0, end = 0;
+    int    edits = 0;
+};
+
+class Pattern {
+public:
+    /* max_edits < 0 → one edit per 5 characters (short words stay exact) */
+    explicit Pattern(std::string p, int max_edits = -1)
+        : p_(std::move(p)),
+          k_(max_edits >= 0 ? max_edits : int(p_.size() / 5)),
+          blocks_((p_.size() + 63) / 64)
+    {
+        peq_.assign(blocks_, {});
+        for (size_t i = 0; i < p_.size(); ++i)
+            peq_[i / 64][static_cast<unsigned char>(p_[i])] |= uint64_t(1) << (i % 64);
+    }
+
+    const std::string& text()      const { return p_; }
+    int                max_edits() const { return k_; }
+
+    /* non-overlapping matches, left to right; each is the lowest-cost end
+       of its run of accepted end positions                               */
+    std::vector<Match> find(std::string_view t, bool first_only = false) const
+    {
+        std::vector<Match> out;
+        const size_t m = p_.size();
+        if (m == 0 || t.empty()) return out;
+
+        std::vector<uint64_t> pv(blocks_, ~uint64_t(0)), mv(blocks_, 0);
+        std::vector<int>      score(blocks_);
+        for (size_t b = 0; b < blocks_; ++b) score[b] = int(std::min(m, (b + 1) * 64));
+        const int last_bit = int((m - 1) % 64);
+
+        size_t run_end = 0; int run_best = k_ + 1;   // best end inside the current run
+        auto flush = [&] {
+            if (run_best > k_) return;
+            Match mt = locate(t, run_end, run_best);
+            if (out.empty() || mt.begin >= out.back().end) out.push_back(mt);
+            run_best = k_ + 1;
+        };
+
+        for (size_t j = 0; j < t.size(); ++j) {
+            const unsigned char c = static_cast<unsigned char>(t[j]);
+            int hin = 0;                                 // row 0 is all zeros: search mode
+            for (size_t b = 0; b < blocks_; ++b) {
+                uint64_t eq = peq_[b][c];
+                const uint64_t neg = hin < 0 ? 1 : 0;
+                const uint64_t xv  = eq | mv[b];
+                eq |= neg;
+                const uint64_t xh  = (((eq & pv[b]) + pv[b]) ^ pv[b]) | eq;
+                uint64_t ph = mv[b] | ~(xh | pv[b]);
+                uint64_t mh = pv[b] & xh;
+
+                const int bit = b + 1 == blocks_ ? last_bit : 63;
+                const int hout = int((ph >> bit) & 1) - int((mh >> bit) & 1);
+
+                ph = (ph << 1) | (hin > 0 ? 1 : 0);
+                mh = (mh << 1) | neg;
+                pv[b] = mh | ~(xv | ph);
+                mv[b] = ph & xv;
+                score[b] += hout;
+                hin = hout;
+            }
+
+            const int s = score[blocks_ - 1];
+            if (s <= k_) {
+                if (s < run_best) { run_best = s; run_end = j + 1; }
+            } else if (run_best <= k_) {
+                flush();
+                if (first_only && !out.empty()) return out;
+            }
+        }
+        flush();
+        if (first_only && out.size() > 1) out.resize(1);
+        return out;
+    }
+
+private:
+    /* start of the best alignment ending at `end` with `edits` – DP over the
+       reversed pattern / text window, longest exact-cost alignment wins     */
+    Match locate(std::string_view t, size_t end, int edits) const
+    {
+        const size_t m = p_.size();
+        const size_t span = std::min(end, m + size_t(k_));
+        std::vector<int> prev(m + 1), cur(m + 1);
+        for (size_t i = 0; i <= m; ++i) prev[i] = int(i);
+
+        size_t begin = end;                              // empty alignment when m ≤ k
+        for (size_t l = 1; l <= span; ++l) {
+            const char tc = t[end - l];
+            cur[0] = int(l);
+            for (size_t i = 1; i <= m; ++i) {
+                const int sub = prev[i - 1] + (p_[m - i] != tc);
+                cur[i] = std::min({ sub, prev[i] + 1, cur[i - 1] + 1 });
+            }
+            if (cur[m] == edits) begin = end - l;
+            std::swap(prev, cur);
+        }
+        return Match{ begin, end, edits };
+    }
+
+    std::string                             p_;
+    int                                     k_;
+    size_t                                  blocks_;
+    std::vector<std::array<uint64_t, 256>>  peq_;
+};
+
+/*───────────────────────────  word stream  ─────────────────────────────────*/
+/* Simplified words of one recognition pass glued into a single text; each
+   character remembers its word so matches map back to word boxes.        */
+template <class Box>
+struct Stream {
+    struct Word {
+        Box   box;
+        float conf = 0.f;
+    };
+    std::string       text;
+    std::vector<int>  owner;       // text index → word index (-1 = line break)
+    std::vector<Word> words;
+
+    void add(const std::string& simplified, const Box& box, float conf, bool new_line)
+    {
+        if (new_line && !text.empty()) { text.push_back('\n'); owner.push_back(-1); }
+        words.push_back({ box, conf });
+        text += simplified;
+        owner.insert(owner.end(), simplified.size(), int(words.size() - 1));
+    }
+
+    /* words [first, last] covered by a match */
+    std::pair<int, int> span(const Match& mt) const
+    {
+        int first = -1, last = -1;
+        for (size_t i = mt.begin; i < mt.end; ++i) {
+            if (owner[i] < 0) continue;
+            if (first < 0) first = owner[i];
+            last = owner[i];
+        }
+        return { first, last };
+    }
+};
+
+} // namespace fuzzy
+} // namespace so
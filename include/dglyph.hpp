@@ -0,0 +1,339 @@
+// dglyph.hpp
+#pragma once
+/*  Glyph-template OCR for the game's fixed bitmap fonts.
+ *
+ *  Prices, quantities and pods are drawn with a handful of pixel fonts, so a
+ *  lookup against an atlas of known glyphs reads them in microseconds where
+ *  the LSTM needs tens of milliseconds:
+ *
+ *      BGRA ROI ─► luminance + Otsu ─► ink band ─► column runs = glyphs
+ *               ─► 16x16 normalised cell ─► SAD against every template
+ *                  of similar width (SSE2 _mm_sad_epu8, 16 loads per cell)
+ *
+ *  Every character comes back with a confidence (similarity, damped when the
+ *  runner-up is close) so callers can hand weak reads to Tesseract.
+ *
+ *  Portable on purpose (no windows.h / OpenCV): the atlas is harvested
+ *  offline from session recordings, see glyph_harvest.cpp.
+ */
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include <string>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <fstream>
+#if defined(__SSE2__)
+  #include <emmintrin.h>
+#endif
+#include "dlog.hpp"
+
+namespace so {
+namespace glyph {
+
+constexpr int N = 16;                          // template cell is N x N bytes
+
+/*──────────────────────────────  data types  ───────────────────────────────*/
+struct Template {
+    std::string ch;                            // one UTF-8 code point
+    uint8_t     w = 0, h = 0;                  // glyph box before normalising
+    alignas(16) std::array<uint8_t, N * N> cell{};
+};
+
+struct Glyph {                                 // one segmented column run
+    int x0 = 0, x1 = 0;                        // [x0, x1) in ROI coords
+    int y0 = 0, y1 = 0;                        // tight ink rows
+    alignas(16) std::array<uint8_t, N * N> cell{};
+    bool space_before = false;
+};
+
+struct Char {
+    std::string ch;
+    float       conf = 0.f;                    // 0 … 1
+};
+
+struct Result {
+    std::string       text;
+    std::vector<Char> chars;
+    float             min_conf = 0.f;          // weakest character (0 if none)
+};
+
+/*───────────────────────────────  helpers  ─────────────────────────────────*/
+namespace detail {
+
+/* Σ|a-b| over one N x N cell */
+inline uint32_t sad(const uint8_t* a, const uint8_t* b)
+{
+#if defined(__SSE2__)
+    __m128i acc = _mm_setzero_si128();
+    for (int i = 0; i < N * N; i += 16) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(va, vb));
+    }
+    return uint32_t(_mm_cvtsi128_si32(acc) + _mm_cvtsi128_si32(_mm_srli_si128(acc, 8)));
+#else
+    uint32_t s = 0;
+    for (int i = 0; i < N * N; ++i) s += uint32_t(std::abs(int(a[i]) - int(b[i])));
+    return s;
+#endif
+}
+
+/* split UTF-8 into code points, dropping whitespace */
+inline std::vector<std::string> code_points(const std::string& s)
+{
+    std::vector<std::string> out;
+    for (size_t i = 0; i < s.size();) {
+        unsigned char c = static_cast<unsigned char>(s[i]);
+        size_t n = c < 0x80 ? 1 : (c >> 5) == 0x6 ? 2 : (c >> 4) == 0xE ? 3 : 4;
+        if (!std::isspace(c)) out.push_back(s.substr(i, n));
+        i += n;
+    }
+    return out;
+}
+
+/* Otsu threshold over a 256-bin histogram */
+inline int otsu(const uint32_t hist[256], uint32_t total)
+{
+    double sum = 0;
+    for (int i = 0; i < 256; ++i) sum += double(i) * hist[i];
+    double sumB = 0, best = -1; uint32_t wB = 0; int thr = 128;
+    for (int t = 0; t < 256; ++t) {
+        wB += hist[t];
+        if (!wB) continue;
+        uint32_t wF = total - wB;
+        if (!wF) break;
+        sumB += double(t) * hist[t];
+        double mB = sumB / wB, mF = (sum - sumB) / wF;
+        double between = double(wB) * wF * (mB - mF) * (mB - mF);
+        if (between > best) { best = between; thr = t; }
+    }
+    return thr;
+}
+} // namespace detail
+
+/*──────────────────────────────  segmentation  ─────────────────────────────*/
+/* binarise a BGRA (or BGR, `channels`) ROI and cut it into glyph cells.
+ * Text is whichever side of the Otsu split has fewer pixels.             */
+inline std::vector<Glyph> segment(const uint8_t* bits, int w, int h, size_t stride,
+                                  int channels = 4)
+{
+    std::vector<Glyph> out;
+    if (!bits || w <= 0 || h <= 0) return out;
+
+    /* 1. luminance + histogram */
+    std::vector<uint8_t> lum(size_t(w) * h);
+    uint32_t hist[256] = {};
+    for (int y = 0; y < h; ++y) {
+        const uint8_t* p = bits + y * stride;
+        uint8_t*       l = lum.data() + size_t(y) * w;
+        for (int x = 0; x < w; ++x, p += channels) {
+            uint8_t v = channels >= 3 ? uint8_t((p[0] * 29 + p[1] * 150 + p[2] * 77) >> 8) : p[0];
+            l[x] = v; ++hist[v];
+        }
+    }
+    const int thr = detail::otsu(hist, uint32_t(w) * h);
+    uint32_t above = 0;
+    for (int i = thr + 1; i < 256; ++i) above += hist[i];
+    const bool light_text = above * 2 < uint32_t(w) * h;
+
+    /* 2. ink mask (255 = ink) kept for the cells, column / row projections */
+    std::vector<uint8_t> ink(lum.size());
+    std::vector<int>     col(w, 0), row(h, 0);
+    for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w; ++x) {
+            uint8_t v = lum[size_t(y) * w + x];
+            bool on = light_text ? v > thr : v <= thr;
+            if (on) { ink[size_t(y) * w + x] = 255; ++col[x]; ++row[y]; }
+        }
+
+    /* 3. text band: the tallest run of inked rows */
+    int by0 = 0, by1 = 0;
+    for (int y = 0; y < h;) {
+        if (!row[y]) { ++y; continue; }
+        int s = y; while (y < h && row[y]) ++y;
+        if (y - s > by1 - by0) { by0 = s; by1 = y; }
+    }
+    if (by1 <= by0) return out;
+    std::fill(col.begin(), col.end(), 0);
+    for (int y = by0; y < by1; ++y)
+        for (int x = 0; x < w; ++x) col[x] += ink[size_t(y) * w + x] ? 1 : 0;
+
+    /* 4. column runs → glyphs */
+    const int band = by1 - by0;
+    for (int x = 0; x < w;) {
+        if (!col[x]) { ++x; continue; }
+        Glyph g; g.x0 = x;
+        while (x < w && col[x]) ++x;
+        g.x1 = x;
+
+        g.y0 = by1; g.y1 = by0;
+        for (int y = by0; y < by1; ++y)
+            for (int xx = g.x0; xx < g.x1; ++xx)
+                if (ink[size_t(y) * w + xx]) { g.y0 = std::min(g.y0, y); g.y1 = std::max(g.y1, y + 1); break; }
+        if (g.y1 <= g.y0) continue;
+
+        /* 5. normalise: the band height maps to N rows (so '.' stays small),
+              width scaled by the same factor, nearest neighbour, left-aligned */
+        const float s = float(N) / float(std::max(band, g.x1 - g.x0));
+        for (int cy = 0; cy < N; ++cy) {
+            int sy = by0 + int(cy / s);
+            if (sy >= by1) break;
+            for (int cx = 0; cx < N; ++cx) {
+                int sx = g.x0 + int(cx / s);
+                if (sx >= g.x1) break;
+                g.cell[cy * N + cx] = ink[size_t(sy) * w + sx];
+            }
+        }
+        out.push_back(g);
+    }
+
+    /* 6. spaces: a gap well above the usual letter spacing (median gap) */
+    if (out.size() > 1) {
+        std::vector<int> gaps;
+        for (size_t i = 1; i < out.size(); ++i) gaps.push_back(out[i].x0 - out[i - 1].x1);
+        std::vector<int> sorted = gaps;
+        std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+        const int space_gap = std::max({ 3, band / 3, 2 * sorted[sorted.size() / 2] + 1 });
+        for (size_t i = 1; i < out.size(); ++i) out[i].space_before = gaps[i - 1] >= space_gap;
+    }
+    return out;
+}
+
+/*────────────────────────────────  atlas  ──────────────────────────────────*/
+class Atlas {
+public:
+    size_t size() const { return t_.size(); }
+    bool   empty() const { return t_.empty(); }
+    const std::vector<Template>& templates() const { return t_; }
+
+    /* keep at most `per_char` distinct samples of each character */
+    bool add(const std::string& ch, const Glyph& g, size_t per_char = 8)
+    {
+        size_t have = 0;
+        for (const Template& t : t_) {
+            if (t.ch != ch) continue;
+            if (detail::sad(t.cell.data(), g.cell.data()) < 255u * 4) return false;   // near duplicate
+            ++have;
+        }
+        if (have >= per_char) return false;
+        Template t;
+        t.ch = ch;
+        t.w  = uint8_t(std::min(255, g.x1 - g.x0));
+        t.h  = uint8_t(std::min(255, g.y1 - g.y0));
+        t.cell = g.cell;
+        t_.push_back(t);
+        return true;
+    }
+
+    /* [magic] u32 count { u8 len, bytes, u8 w, u8 h, N*N cell }* */
+    bool save(const std::string& path) const
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        out.write(kMagic, sizeof kMagic);
+        uint32_t n = uint32_t(t_.size());
+        out.write(reinterpret_cast<const char*>(&n), sizeof n);
+        for (const Template& t : t_) {
+            uint8_t len = uint8_t(t.ch.size());
+            out.write(reinterpret_cast<const char*>(&len), 1);
+            out.write(t.ch.data(), len);
+            out.write(reinterpret_cast<const char*>(&t.w), 1);
+            out.write(reinterpret_cast<const char*>(&t.h), 1);
+            out.write(reinterpret_cast<const char*>(t.cell.data()), t.cell.size());
+        }
+        return bool(out);
+    }
+
+    bool load(const std::string& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return false;
+        char magic[8] = {};
+        uint32_t n = 0;
+        if (!in.read(magic, sizeof magic) || std::memcmp(magic, kMagic, sizeof kMagic) != 0
+            || !in.read(reinterpret_cast<char*>(&n), sizeof n)) {
+            LOG_WARN("[glyph] %s is not a glyph atlas\n", path.c_str());
+            return false;
+        }
+        t_.clear(); t_.reserve(n);
+        for (uint32_t i = 0; i < n; ++i) {
+            Template t; uint8_t len = 0;
+            if (!in.read(reinterpret_cast<char*>(&len), 1)) break;
+            t.ch.resize(len);
+            in.read(t.ch.data(), len);
+            in.read(reinterpret_cast<char*>(&t.w), 1);
+            in.read(reinterpret_cast<char*>(&t.h), 1);
+            if (!in.read(reinterpret_cast<char*>(t.cell.data()), t.cell.size())) break;
+            t_.push_back(t);
+        }
+        LOG_INFO("[glyph] atlas %s: %zu templates\n", path.c_str(), t_.size());
+        return true;
+    }
+
+private:
+    static constexpr char kMagic[8] = {'D','G','L','Y','P','H','0','1'};
+    std::vector<Template> t_;
+};
+
+/*───────────────────────────────  classify  ────────────────────────────────*/
+/* read a ROI against the atlas.  `margin` is the similarity gap to the best
+ * different character below which a read is considered ambiguous.        */
+inline Result read(const Atlas& atlas, const uint8_t* bits, int w, int h, size_t stride,
+                   int channels = 4, float margin = 0.04f)
+{
+    Result r;
+    if (atlas.empty()) return r;
+
+    const float full = 255.f * N * N;
+    r.min_conf = 1.f;
+    for (const Glyph& g : segment(bits, w, h, stride, channels)) {
+        const int gw = g.x1 - g.x0;
+        uint32_t best = UINT32_MAX, second = UINT32_MAX;
+        const Template* bt = nullptr;
+        for (const Template& t : atlas.templates()) {
+            if (std::abs(int(t.w) - gw) > 2) continue;              // width pre-filter
+            uint32_t d = detail::sad(t.cell.data(), g.cell.data());
+            if (d < best) {
+                if (bt && bt->ch != t.ch) second = best;
+                best = d; bt = &t;
+            } else if (d < second && bt && t.ch != bt->ch) {
+                second = d;
+            }
+        }
+
+        Char c;
+        if (bt) {
+            float sim  = 1.f - best / full;
+            float gap  = second == UINT32_MAX ? 1.f : (float(second) - float(best)) / full;
+            c.ch   = bt->ch;
+            c.conf = gap >= margin ? sim : sim * (gap / margin);
+        } else {
+            c.ch = "?"; c.conf = 0.f;
+        }
+        if (g.space_before) r.text += ' ';
+        r.text += c.ch;
+        r.min_conf = std::min(r.min_conf, c.conf);
+        r.chars.push_back(c);
+    }
+    if (r.chars.empty()) r.min_conf = 0.f;
+    return r;
+}
+
+/* label the glyphs of a ROI with known text; false when the segmentation
+ * does not line up one glyph per character (touching / broken glyphs)     */
+inline bool harvest(Atlas& atlas, const std::string& text,
+                    const uint8_t* bits, int w, int h, size_t stride, int channels = 4)
+{
+    std::vector<std::string> cps = detail::code_points(text);
+    std::vector<Glyph>       gs  = segment(bits, w, h, stride, channels);
+    if (cps.empty() || cps.size() != gs.size()) return false;
+    for (size_t i = 0; i < gs.size(); ++i) atlas.add(cps[i], gs[i]);
+    return true;
+}
+
+} // namespace glyph
+} // namespace so
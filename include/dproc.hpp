@@ -9,26 +9,184 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <chrono>
 #include <thread>
 #include <cctype>
+#include <cstdlib>
+#include <iterator>
+#include <deque>
+#include <variant>
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+#include <charconv>
+#include <algorithm>
+#include <unordered_map>
 #include <iomanip>
 
 #include "dlog.hpp"
 #include "dutils.hpp"       // du::trim / trim_quotes / simplify
 #include "dwin_api.hpp"     // dw::* helpers
 #include "dscreen_ocr.hpp"  // so::read_region / locate_text
+#include "dtemplate.hpp"    // so::locate_template
+#include "drecord.hpp"      // dr::session() – optional run recording
+#include "dsink.hpp"        // ds::Sinks – save target
 
 namespace dp {
 
+/*──────────────────── variables ──────────────────────────*/
+/* Variable names are interned to slots when a proc is compiled, so a
+   set / OCR / save touches a vector entry, not a string-keyed tree.     */
+class Symbols {
+public:
+    static Symbols& get()
+    {
+        static Symbols s; return s;
+    }
+
+    int intern(std::string_view name)
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto it = index_.find(name);
+        if (it != index_.end()) return it->second;
+        names_.emplace_back(name);
+        const int slot = int(names_.size() - 1);
+        index_.emplace(names_.back(), slot);
+        return slot;
+    }
+
+    /* slot of an already interned name, -1 otherwise – never adds one */
+    int lookup(std::string_view name) const
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto it = index_.find(name);
+        return it != index_.end() ? it->second : -1;
+    }
+
+    const std::string& name(int slot) const
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        return names_[size_t(slot)];              // deque: stays put while others are added
+    }
+
+private:
+    std::deque<std::string>                   names_;
+    std::unordered_map<std::string_view, int> index_;   // views into names_
+    mutable std::mutex                        mu_;
+};
+
+/* one variable: text, or a number once a numeric OCR profile parsed it */
+struct Value {
+    std::variant<std::string, int64_t, double> v;
+
+    Value() = default;
+    Value(std::string s) : v(std::move(s)) {}
+    Value(const char* s) : v(std::string(s)) {}
+    Value(int64_t i)     : v(i) {}
+    Value(double d)      : v(d) {}
+
+    bool is_text() const { return std::holds_alternative<std::string>(v); }
+
+    std::string text() const
+    {
+        if (auto s = std::get_if<std::string>(&v)) return *s;
+        if (auto i = std::get_if<int64_t>(&v))     return std::to_string(*i);
+        char buf[32]; std::snprintf(buf, sizeof buf, "%.15g", std::get<double>(v));
+        return buf;
+    }
+
+    /* append_vars / OCR_append: numbers turn back into text first */
+    Value& operator+=(const std::string& s)
+    {
+        if (!is_text()) v = text();
+        std::get<std::string>(v) += s;
+        return *this;
+    }
+
+    /* JSON literal: numbers bare, text quoted */
+    std::string json() const { return is_text() ? "\"" + du::jesc(text()) + "\"" : text(); }
+};
+
+class Vars {
+public:
+    Value& operator[](int slot)
+    {
+        if (size_t(slot) >= vals_.size()) { vals_.resize(size_t(slot) + 1); set_.resize(size_t(slot) + 1, 0); }
+        if (!set_[size_t(slot)]) { set_[size_t(slot)] = 1; ++count_; }
+        return vals_[size_t(slot)];
+    }
+    Value& operator[](std::string_view name) { return (*this)[Symbols::get().intern(name)]; }
+
+    /* read-only: an unknown name is not interned (a typo stays a miss) */
+    const Value* find(std::string_view name) const
+    {
+        const int slot = Symbols::get().lookup(name);
+        return slot >= 0 && size_t(slot) < vals_.size() && set_[size_t(slot)] ? &vals_[size_t(slot)] : nullptr;
+    }
+
+    size_t size() const { return count_; }
+
+    void clear()
+    {
+        std::fill(set_.begin(), set_.end(), 0);
+        for (Value& v : vals_) v = Value{};
+        count_ = 0;
+    }
+
+    /* f(name, value) over the set variables, by name (the order save used) */
+    template <class F>
+    void for_each(F&& f) const
+    {
+        std::vector<std::pair<const std::string*, const Value*>> items;
+        items.reserve(count_);
+        for (size_t i = 0; i < vals_.size(); ++i)
+            if (set_[i]) items.push_back({ &Symbols::get().name(int(i)), &vals_[i] });
+        std::sort(items.begin(), items.end(), [](auto& a, auto& b) { return *a.first < *b.first; });
+        for (auto& [n, v] : items) f(*n, *v);
+    }
+
+private:
+    std::vector<Value>   vals_;
+    std::vector<uint8_t> set_;
+    size_t               count_ = 0;
+};
+
 /*──────────────────── runtime context ────────────────────*/
 struct Context {
     HWND hwnd{};
-    std::map<std::string, std::string> vars;
-    cv::Mat prev;
+    Vars vars;
+    so::FramePtr prev;                  // keeps its capture slot leased
+    std::shared_ptr<so::OcrSession> ocr;  // `ocr_session` – fields read off one frame
 };
 
+/* OCR one field: through the open session while its frame is current (no
+   input since) and covers the field, otherwise a fresh read_region        */
+inline std::string read_field(Context& ctx, const RECT& rc, const std::string& prof = "")
+{
+    if (ctx.ocr && ctx.ocr->frame()->input_seq != dw::input_seq()) {
+        LOG_DEBUG("[run_proc] ocr_session closed by input\n");
+        ctx.ocr.reset();
+    }
+    if (ctx.ocr && ctx.ocr->covers(rc)) return ctx.ocr->read(rc, prof);
+    return so::read_region(ctx.hwnd, rc, prof);
+}
+
+/* OCR text as stored in a variable: a number when the field's profile
+   says so (ocr_profile_<name>_type) and the text holds one             */
+inline Value typed(std::string text, const std::string& prof)
+{
+    const so::OcrProfile* p = prof.empty() ? nullptr : so::OcrProfiles::get().find(prof);
+    if (!p || p->type == so::OcrProfile::Type::Text) return Value(std::move(text));
+    auto n = du::parse_decimal(text);
+    if (!n) return Value(std::move(text));
+    if (p->type == so::OcrProfile::Type::Int) return Value(int64_t(std::llround(*n)));
+    return Value(*n);
+}
+
 /*──────────────────── function registry ──────────────────*/
 using Fn = bool(*)(Context&, const std::vector<std::string>&);
 
@@ -38,7 +196,10 @@ using Fn = bool(*)(Context&, const std::vector<std::string>&);
 static const std::unordered_map<std::string, Fn> FN_TABLE = {
     {"click_next_item_in_line", &dp_fn::click_next_item_in_line},
     {"read_from_selected_item", &dp_fn::read_from_selected_item},
-    {"change_map", &dp_fn::change_map}
+    {"change_map", &dp_fn::change_map},
+    {"roi_changed", &dp_fn::roi_changed},
+    {"ocr_fields", &dp_fn::ocr_fields},
+    {"find_template", &dp_fn::find_template}
 };
 
 /*──────────────────── helpers ────────────────────────────*/
@@ -46,7 +207,7 @@ inline std::optional<RECT> find_phrase_bbox(HWND hwnd,
                                             const std::string& phrase,
                                             double conf = 60)
 {
-    auto hits = so::locate_text(hwnd, phrase, conf);
+    auto hits = so::locate_text(hwnd, phrase, conf, /*first_only=*/true);
     if (hits.empty()) return std::nullopt;
     return hits.front();
 }
@@ -56,302 +217,989 @@ inline std::optional<RECT> find_phrase_bbox(HWND hwnd,
                                             const std::string& phrase,
                                             double conf = 60)
 {
-    auto hits = so::locate_text(hwnd, roi, phrase, conf);
+    auto hits = so::locate_text(hwnd, roi, phrase, conf, /*first_only=*/true);
     if (hits.empty()) return std::nullopt;
     return hits.front();
 }
 
-/* expand $1 … $N ----------------------------------------------------------*/
-inline std::string expand_args(std::string_view line,
-    const std::vector<std::string>& args)
+/* in a frame already captured – the one a wait just compared */
+inline std::optional<RECT> find_phrase_bbox(const so::FramePtr& f,
+                                            const std::string& phrase,
+                                            double conf = 60)
+{
+    auto hits = so::locate_text(f, RECT{}, phrase, conf, /*first_only=*/true);
+    if (hits.empty()) return std::nullopt;
+    return hits.front();
+}
+
+/* polling interval for the wait_* commands: starts at wait_poll_min_ms,
+   grows ×1.5 up to wait_poll_max_ms while nothing happens; wait_change /
+   wait_stable start over after a change (wait_phrase does not – its OCR
+   passes are rate-limited instead). Marks the frame stale first, so the
+   next capture is new.                                                    */
+class Backoff {
+public:
+    Backoff()
+        : min_(std::max(1, CFG_INT("wait_poll_min_ms", 10))),
+          max_(std::max(min_, CFG_INT("wait_poll_max_ms", 150))),
+          cur_(min_) {}
+
+    /* next interval, or `floor_ms` when that is longer */
+    void sleep(int floor_ms = 0)
+    {
+        so::invalidate_frame();
+        std::this_thread::sleep_for(std::chrono::milliseconds(std::max(cur_, floor_ms)));
+        cur_ = std::min(max_, cur_ + cur_ / 2 + 1);
+        ++polls_;
+    }
+    void reset() { cur_ = min_; }
+    int  polls() const { return polls_; }
+
+private:
+    int min_, max_, cur_;
+    int polls_ = 0;
+};
+
+/* rc differs from `since` – same test (and threshold) as break_if_no_diff,
+   tile hashes first, so an unchanged screen costs next to nothing       */
+inline bool region_changed(HWND hwnd, const so::FramePtr& since, const RECT& rc)
+{
+    static const double thr = CFG_DBL("diff_comparison_humbral", 0.5);
+    return so::compare_imag(hwnd, since, rc) <= thr;
+}
+
+inline int ms_since(std::chrono::steady_clock::time_point t)
+{
+    return int(std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now() - t).count());
+}
+
+/*──────────────────── compiled procedures ────────────────*/
+/* A .proc line becomes an Instr once per file version: comments stripped,
+   tokens split (quotes honoured), numbers parsed. Tokens that mention $N
+   keep their text and are expanded against the arguments of each call;
+   every other operand is ready to use.                                   */
+struct Operand {
+    std::string text;          // token without its quotes
+    std::string rest;          // line from this token on (free-text commands),
+                               // trim_quotes'd unless rest_dyn
+    long long   i   = 0;
+    double      d   = 0;
+    bool        num      = false;   // the whole token is a number
+    bool        dyn      = false;   // text mentions $N – resolved per call
+    bool        rest_dyn = false;   // so does rest
+    int         slot     = -1;      // variable operand: interned name
+};
+
+struct Instr {
+    std::string          cmd;
+    std::vector<Operand> ops;
+    std::string          src;          // comment-stripped line (recorder / errors)
+    int                  line = 0;
+    int                  op   = -1;     // index into COMMANDS, -1 = unknown
+    bool                 dyn  = false;  // the line mentions $N
+};
+
+struct Program {
+    std::string              name;
+    std::vector<Instr>       code;
+    std::vector<std::string> errors;    // "name:line: message", empty when runnable
+};
+using ProgramPtr = std::shared_ptr<const Program>;
+
+namespace detail {
+
+/* whole-token number; leading-number prefixes ("12px") stay text */
+/* [+-]digits[.digits] only – no nan / inf / hex / exponent, and the
+   integer part must fit a long long                                     */
+inline bool parse_num(std::string_view s, long long& i, double& d)
+{
+    const size_t sign = !s.empty() && (s[0] == '+' || s[0] == '-');
+    const size_t dot  = s.find('.');
+    std::string_view ip = s.substr(sign, dot == std::string_view::npos ? s.npos : dot - sign);
+    std::string_view fp = dot == std::string_view::npos ? std::string_view() : s.substr(dot + 1);
+    auto digits = [](std::string_view v) {
+        return !v.empty() && std::all_of(v.begin(), v.end(), [](char c) { return c >= '0' && c <= '9'; });
+    };
+    if (!digits(ip) || (dot != std::string_view::npos && !digits(fp))) return false;
+
+    long long v = 0;
+    if (std::from_chars(ip.data(), ip.data() + ip.size(), v).ec != std::errc()) return false;
+    i = s[0] == '-' ? -v : v;
+    d = std::strtod(std::string(s).c_str(), nullptr);
+    return true;
+}
+
+/* $1 … $N in one pass (so $10 is not $1 followed by 0); unknown slots
+   stay literal, as they always did                                     */
+inline std::string expand(std::string_view s, const std::vector<std::string>& args)
 {
-    if (args.empty()) return std::string(line);
+    std::string out;
+    out.reserve(s.size());
+    for (size_t p = 0; p < s.size();) {
+        if (s[p] == '$' && p + 1 < s.size() && std::isdigit(static_cast<unsigned char>(s[p + 1]))) {
+            size_t q = p + 1; size_t n = 0;
+            while (q < s.size() && std::isdigit(static_cast<unsigned char>(s[q]))) n = n * 10 + size_t(s[q++] - '0');
+            if (n >= 1 && n <= args.size()) { out += args[n - 1]; p = q; continue; }
+        }
+        out += s[p++];
+    }
+    return out;
+}
 
-    std::string out(line);
-    for (size_t k = 0; k < args.size(); ++k) {
-        std::string key = '$' + std::to_string(k + 1);
-        std::string repl = args[k];
+inline bool mentions_arg(std::string_view s)
+{
+    for (size_t p = 0; p + 1 < s.size(); ++p)
+        if (s[p] == '$' && std::isdigit(static_cast<unsigned char>(s[p + 1]))) return true;
+    return false;
+}
 
-        size_t pos = 0;
-        while ((pos = out.find(key, pos)) != std::string::npos) {
-            out.replace(pos, key.size(), repl);
-            pos += repl.size();
+/* "a b" stays one token; \" inside quotes is a quote (std::quoted rules) */
+inline std::vector<std::pair<std::string, size_t>> tokenize(std::string_view s)
+{
+    std::vector<std::pair<std::string, size_t>> out;   // token, source offset
+    size_t p = 0;
+    while (true) {
+        while (p < s.size() && std::isspace(static_cast<unsigned char>(s[p]))) ++p;
+        if (p >= s.size()) break;
+        const size_t at = p;
+        std::string tok;
+        if (s[p] == '"') {
+            for (++p; p < s.size() && s[p] != '"'; ++p) {
+                if (s[p] == '\\' && p + 1 < s.size()) ++p;
+                tok += s[p];
+            }
+            if (p < s.size()) ++p;                     // closing quote
+        } else {
+            while (p < s.size() && !std::isspace(static_cast<unsigned char>(s[p]))) tok += s[p++];
         }
+        out.emplace_back(std::move(tok), at);
     }
     return out;
 }
 
-/*──────────────────── core interpreter ──────────────────*/
-inline bool run_proc(Context& ctx,
-                     const std::string&              name,
-                     const std::vector<std::string>& args  = {},
-                     int                              depth = 0)
+inline Instr compile_line(std::string_view src, int line)
 {
-    /*── entry ───────────────────────────────────────────*/
-    LOG_EVENT("[run_proc] run_proc  name='%s'  depth=%d  argc=%zu\n",
-              name.c_str(), depth, args.size());
+    Instr in;
+    in.src  = std::string(src);
+    in.line = line;
+    in.dyn  = mentions_arg(src);
+    auto toks = tokenize(src);
+    in.cmd = std::move(toks[0].first);
+    for (size_t k = 1; k < toks.size(); ++k) {
+        Operand o;
+        o.text     = std::move(toks[k].first);
+        o.rest     = du::trim(src.substr(toks[k].second));
+        o.dyn      = mentions_arg(o.text);
+        o.rest_dyn = mentions_arg(o.rest);
+        if (!o.rest_dyn) o.rest = du::trim_quotes(o.rest);
+        if (!o.dyn)      o.num  = parse_num(o.text, o.i, o.d);
+        in.ops.push_back(std::move(o));
+    }
+    return in;
+}
 
-    if (depth > 10) {
-        LOG_ERROR("[run_proc] proc recursion too deep – aborting (%s)\n", name.c_str());
-        return false;
+} // namespace detail
+
+/* lines → Program, opcodes resolved and operands checked (below the table) */
+inline Program compile(const std::string& name, const std::vector<std::string>& lines);
+
+/* operands of one instruction as seen by one call: static ones straight
+   from the Instr, $N ones expanded (and parsed) on first use            */
+class Ops {
+public:
+    Ops(const Instr& in, const std::vector<std::string>& args) : in_(in), args_(args) {}
+
+    size_t size() const { return in_.ops.size(); }
+
+    const std::string& str(size_t k)
+    {
+        static const std::string none;
+        if (k >= size()) return none;
+        const Operand& o = in_.ops[k];
+        if (!o.dyn) return o.text;
+        if (exp_.size() < size()) exp_.resize(size());
+        if (!exp_[k]) exp_[k] = detail::expand(o.text, args_);
+        return *exp_[k];
     }
 
-    std::filesystem::path folder = CFG_STR("procedure_folder", "./procedures");
-    std::filesystem::path file   = folder / (name + ".proc");
+    bool is_num(size_t k)
+    {
+        if (k >= size()) return false;
+        const Operand& o = in_.ops[k];
+        if (!o.dyn) return o.num;
+        long long i; double d;
+        return detail::parse_num(str(k), i, d);
+    }
 
-    LOG_DEBUG("[run_proc] opening file: %s\n", file.string().c_str());
-    std::ifstream in(file);
-    if (!in) {
-        LOG_ERROR("[run_proc] proc not found: %s\n", file.string().c_str());
-        return false;
+    /* missing / non-numeric operands read as 0, like a failed `ss >> x` */
+    long long i(size_t k)
+    {
+        if (k >= size()) return 0;
+        const Operand& o = in_.ops[k];
+        if (!o.dyn) return o.i;
+        return std::strtoll(str(k).c_str(), nullptr, 10);
+    }
+    double d(size_t k)
+    {
+        if (k >= size()) return 0;
+        const Operand& o = in_.ops[k];
+        if (!o.dyn) return o.d;
+        return std::strtod(str(k).c_str(), nullptr);
     }
 
-    std::string raw; int lineno = 0;
+    /* free text from operand k to the end of the line, outer quotes off */
+    std::string rest(size_t k)
+    {
+        if (k >= size()) return {};
+        const Operand& o = in_.ops[k];
+        return o.rest_dyn ? du::trim_quotes(detail::expand(o.rest, args_)) : o.rest;
+    }
 
-    /*── main line-reader loop ───────────────────────────*/
-    while (std::getline(in, raw))
+    std::vector<std::string> strs(size_t from)
     {
-        ++lineno;
-        LOG_DEBUG("[run_proc] [%s:%d] raw: \"%s\"\n",
-                  name.c_str(), lineno, raw.c_str());
+        std::vector<std::string> v;
+        for (size_t k = from; k < size(); ++k) v.push_back(str(k));
+        return v;
+    }
 
-        /* strip comments / blanks */
-        if (auto pos = raw.find('#'); pos != std::string::npos) raw.erase(pos);
-        raw = du::trim(raw);
-        if (raw.empty()) { LOG_DEBUG("[run_proc] …skipped (blank/comment)\n"); continue; }
+    /* variable operand → slot; interned at compile time unless $N */
+    int slot(size_t k)
+    {
+        if (k < size() && in_.ops[k].slot >= 0) return in_.ops[k].slot;
+        return Symbols::get().intern(str(k));
+    }
 
-        raw = expand_args(raw, args);          // substitute $1…$N
-        std::istringstream ss(raw);
-        std::string cmd; ss >> cmd;
+    RECT rect(size_t k)
+    {
+        const int x = int(i(k)), y = int(i(k + 1));
+        return RECT{ x, y, x + int(i(k + 2)), y + int(i(k + 3)) };
+    }
 
-        LOG_DEBUG("[run_proc] cmd='%s'  reset=\"%s\"\n", cmd.c_str(),
-                  raw.substr(cmd.size()).c_str());
+    /* the line as written after $N substitution */
+    std::string line() const { return in_.dyn ? detail::expand(in_.src, args_) : in_.src; }
 
-    /*──────────── flow / tasks ────────────────────*/
-        if (cmd == "loop")
-        {
-            int times = 0; std::string sub; ss >> times >> sub;
+    const Instr& instr() const { return in_; }
 
-            LOG_EVENT("[run_proc] loop  times=%d  sub='%s'\n", times, sub.c_str());
-            if (sub.empty())
-                throw std::runtime_error("loop: missing sub-procedure name");
-            if (times <= 0) continue;          // nothing to do
+private:
+    const Instr&                              in_;
+    const std::vector<std::string>&           args_;
+    std::vector<std::optional<std::string>>   exp_;
+};
 
-            std::vector<std::string> sub_args;
-            std::string tok;
-            while (ss >> tok) sub_args.push_back(du::trim_quotes(tok));
 
-            for (int i = 0; i < times; ++i) {
-                LOG_DEBUG("[run_proc]   ↳ iteration %d/%d\n", i + 1, times);
-                if (!run_proc(ctx, sub, sub_args, depth + 1))
-                    break;
-            }
-        }
-        else if (cmd == "call_proc") {
-            std::string sub; ss >> sub;
-            std::vector<std::string> sub_args;
-            std::string tok; while (ss >> tok) sub_args.push_back(du::trim_quotes(tok));
-            LOG_EVENT("[run_proc] call_proc  sub='%s'  argc=%zu\n", sub.c_str(), sub_args.size());
-            if (!run_proc(ctx, sub, sub_args, depth + 1)) return false;
-        } else if (cmd == "call_fn") {
-            std::string fn;  ss >> fn;
-        
-            std::vector<std::string> fn_args;
-            std::string tok;
-            while (ss >> tok) fn_args.push_back(du::trim_quotes(tok));
-        
-            LOG_EVENT("[run_proc] call_fn  fn='%s'  argc=%zu\n",
-                      fn.c_str(), fn_args.size());
-        
-            auto it = FN_TABLE.find(fn);
-            if (it == FN_TABLE.end()) {
-                LOG_ERROR("unknown fn: %s\n", fn.c_str());
-                return false;
-            }
-        
-            /* invoke; bubble failure up the stack */
-            if (!(*it->second)(ctx, fn_args))
-                return false;
-        }
-    /*──────────────── basic mouse / kbd ───────────────*/
-        else if (cmd == "click")       { int x,y; ss>>x>>y; LOG_EVENT("[run_proc] click (%d,%d)\n",x,y); dw::click(ctx.hwnd,x,y); }
-        else if (cmd == "click_delta") { int x,y,dx,dy; ss>>x>>y>>dx>>dy; LOG_EVENT("[run_proc] click_delta (%d+%d,%d+%d)\n",x,dx,y,dy); dw::click(ctx.hwnd,x+dx,y+dy); }
-        else if (cmd == "dblclick")    { int x,y; ss>>x>>y; LOG_EVENT("[run_proc] dblclick (%d,%d)\n",x,y); dw::dbl_click(ctx.hwnd,x,y); }
-        else if (cmd == "move")        { int x,y; ss>>x>>y; LOG_EVENT("[run_proc] move (%d,%d)\n",x,y); dw::move_cursor(ctx.hwnd,x,y); }
-        else if (cmd == "scroll")      { int x,y,d; ss>>x>>y>>d; LOG_EVENT("[run_proc] scroll (%d,%d) d=%d\n",x,y,d); if(d) dw::mouse_wheel(ctx.hwnd,x,y,d); }
-        else if (cmd == "hold_click")  {
-            int x,y,dur; ss>>x>>y>>dur;
-            LOG_EVENT("[run_proc] hold_click (%d,%d) dur=%dms\n",x,y,dur);
-            if (dur == 0) continue;
-            if (dur < 0)  throw std::runtime_error("hold_click duration must be >0");
-            dw::mouse_down(ctx.hwnd,x,y); ::Sleep(dur); dw::mouse_up(ctx.hwnd,x,y);
-        }
-        else if (cmd == "type")        { std::string t; std::getline(ss,t); t=du::trim_quotes(du::trim(t)); LOG_EVENT("[run_proc] type \"%s\"\n",t.c_str()); dw::send_text(ctx.hwnd,t); }
-        else if (cmd == "key")         { std::string k; ss>>k; LOG_EVENT("[run_proc] key \"%s\"\n",k.c_str()); dw::send_vk_infocus(ctx.hwnd,k); }
-        else if (cmd == "paste")       { std::string t; std::getline(ss,t); t=du::trim_quotes(du::trim(t)); LOG_EVENT("[run_proc] paste \"%s\"\n",t.c_str()); dw::paste(ctx.hwnd,dw::to_wstring(t)); }
-        else if (cmd == "sleep")       { int ms; ss>>ms; LOG_EVENT("[run_proc] sleep %dms\n",ms); std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
-
-    /*──────────────── CTX helpers ─────────────────────*/
-        else if (cmd == "set_prev") {
-            LOG_EVENT("[run_proc] set_prev (capture window)\n");
-            ctx.prev = so::detail::capture(ctx.hwnd);
-        }
-        else if (cmd == "set_vars") {
-            std::string var,value; ss>>var>>value;
-            LOG_EVENT("[run_proc] set_vars  %s = \"%s\"\n",var.c_str(),value.c_str());
-            ctx.vars[var]=value;
-        }
-        else if (cmd == "append_vars") {
-            std::string var,value; ss>>var>>value;
-            LOG_EVENT("[run_proc] append_vars  %s = \"%s\"\n",var.c_str(),value.c_str());
-            ctx.vars[var]+=value;
-        }
-    /*──────────────── OCR helpers ─────────────────────*/
-        else if (cmd == "OCR") {
-            int x,y,w,h; std::string _,var; ss>>x>>y>>w>>h>>_>>var;
-            LOG_EVENT("[run_proc] OCR  (%d,%d,%d,%d) → %s\n",x,y,w,h,var.c_str());
-            RECT rc{x,y,x+w,y+h}; ctx.vars[var]=so::read_region(ctx.hwnd,rc);
-        }
-        else if (cmd == "OCR_diff") {
-            int x,y,w,h; std::string _,var; ss>>x>>y>>w>>h>>_>>var;
-            LOG_EVENT("[run_proc] OCR_diff (%d,%d,%d,%d) → %s\n",x,y,w,h,var.c_str());
-            RECT rc{x,y,x+w,y+h}; ctx.vars[var]=so::read_region(ctx.hwnd,ctx.prev,rc);
-        }
-        else if (cmd == "expect_ocr") {
-            int x,y,w,h; std::string exp; ss>>x>>y>>w>>h; std::getline(ss,exp);
-            exp=du::trim_quotes(du::trim(exp));
-            LOG_EVENT("[run_proc] expect_ocr (%d,%d,%d,%d) exp=\"%s\"\n",x,y,w,h,exp.c_str());
-            RECT rc{x,y,x+w,y+h};
-            std::string txt = so::read_region(ctx.hwnd, rc);
-            if (du::simplify(txt).find(du::simplify(exp)) == std::string::npos)
-                throw std::runtime_error("EXPECT_OCR failed. exp='"+exp+"' got='"+txt+"'");
-        }
-        else if (cmd == "OCR_append") {
-            int x,y,w,h; std::string _,var; ss>>x>>y>>w>>h>>_>>var;
-            LOG_EVENT("[run_proc] OCR  (%d,%d,%d,%d) → %s\n",x,y,w,h,var.c_str());
-            RECT rc{x,y,x+w,y+h}; ctx.vars[var]+=so::read_region(ctx.hwnd,rc);
-        }
-        else if (cmd == "ocr_break") { /* …same pattern, shortened for brevity */ 
-            int x,y,w,h; std::string exp; ss>>x>>y>>w>>h; std::getline(ss,exp);
-            exp=du::trim_quotes(du::trim(exp));
-            LOG_DEBUG("[run_proc] ocr_break (%d,%d,%d,%d) exp=\"%s\"\n",x,y,w,h,exp.c_str());
-            RECT rc{x,y,x+w,y+h};
-            std::string txt = so::read_region(ctx.hwnd, rc);
-            if (du::simplify(txt).find(du::simplify(exp)) != std::string::npos){
-                LOG_EVENT("[run_proc] ocr_break break!\n");
-                return false;
-            }
-            LOG_EVENT("[run_proc] ocr_break NO break!\n");
-        }
-        else if (cmd == "ocr_stop") {
-            int x,y,w,h; std::string exp; ss>>x>>y>>w>>h; std::getline(ss,exp);
-            exp=du::trim_quotes(du::trim(exp));
-            LOG_DEBUG("[run_proc] ocr_stop (%d,%d,%d,%d) exp=\"%s\"\n",x,y,w,h,exp.c_str());
-            RECT rc{x,y,x+w,y+h};
-            std::string txt = so::read_region(ctx.hwnd, rc);
-            if (du::simplify(txt).find(du::simplify(exp)) != std::string::npos){
-                LOG_EVENT("[run_proc] ocr_stop stop!\n");
-                break;
-            }
-            LOG_EVENT("[run_proc] ocr_stop NO stop!\n");
-        }
+/*──────────────────── procedure files ────────────────────*/
+/* Compiled procedures by path, recompiled only when the file's mtime moves;
+   check() compiles a procedure and every sub-procedure it names         */
+class ProcCache {
+public:
+    static ProcCache& get()
+    {
+        static ProcCache c; return c;
+    }
 
-        /*──────────── diff-based break/stop ───────────*/
-        else if (cmd == "break_if_no_diff") {
-            int x,y,w,h; ss>>x>>y>>w>>h;
-            RECT rc{x,y,x+w,y+h};
-            double c = so::compare_imag(ctx.hwnd, ctx.prev, rc);
-            LOG_DEBUG("[run_proc] break_if_no_diff cmp=%f\n", c);
-            if (c > CFG_DBL("diff_comparison_humbral", 0.5)) {
-                LOG_EVENT("[run_proc] break_if_no_diff break!\n");
-                return false;
-            }
-            LOG_EVENT("[run_proc] break_if_no_diff NO break!\n");
-        }
-        else if (cmd == "stop_if_no_diff") {
-            int x,y,w,h; ss>>x>>y>>w>>h;
-            RECT rc{x,y,x+w,y+h};
-            double c = so::compare_imag(ctx.hwnd, ctx.prev, rc);
-            LOG_DEBUG("[run_proc] stop_if_no_diff cmp=%f\n", c);
-            if (c > CFG_DBL("diff_comparison_humbral", 0.5)){
-                LOG_EVENT("[run_proc] stop_if_no_diff stop!\n");
-                break;
-            }
-            LOG_EVENT("[run_proc] stop_if_no_diff NO stop!\n");
-        }
-    /*──────── phrase helpers ───────────*/
-        else if (cmd == "click_phrase") {
-            std::string p; std::getline(ss,p); p=du::trim_quotes(du::trim(p));
-            LOG_EVENT("[run_proc] click_phrase \"%s\"\n",p.c_str());
-            if (auto rc = find_phrase_bbox(ctx.hwnd,p))
-                dw::click(ctx.hwnd,(rc->left+rc->right)/2,(rc->top+rc->bottom)/2);
-            else throw std::runtime_error("click_phrase: not found '"+p+"'");
+    static std::filesystem::path path(const std::string& name)
+    {
+        std::filesystem::path folder = CFG_STR("procedure_folder", "./procedures");
+        return folder / (name + ".proc");
+    }
+
+    /* nullptr when the file is missing */
+    ProgramPtr program(const std::string& name)
+    {
+        const std::filesystem::path file = path(name);
+        std::error_code ec;
+        const auto mtime = std::filesystem::last_write_time(file, ec);
+        if (ec) return nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            auto it = map_.find(file.string());
+            if (it != map_.end() && it->second.mtime == mtime) return it->second.prog;
         }
-        else if (cmd == "wait_phrase") {
-            std::string p; int to; ss>>std::quoted(p)>>to;
-            LOG_EVENT("[run_proc] wait_phrase \"%s\"  timeout=%dms\n",p.c_str(),to);
-            auto start = std::chrono::steady_clock::now();
-            while (std::chrono::steady_clock::now()-start < std::chrono::milliseconds(to)) {
-                if (find_phrase_bbox(ctx.hwnd,p)) break;
-                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        LOG_DEBUG("[run_proc] compiling file: %s\n", file.string().c_str());
+        std::ifstream in(file);
+        if (!in) return nullptr;
+        std::vector<std::string> lines;
+        for (std::string l; std::getline(in, l);) lines.push_back(std::move(l));
+        auto prog = std::make_shared<const Program>(compile(name, lines));
+
+        std::lock_guard<std::mutex> lock(mu_);
+        map_[file.string()] = { mtime, prog };
+        return prog;
+    }
+
+    /* compile `name` and the procs reachable through loop / call_proc and
+       return every problem found, before anything runs; names built from
+       $N arguments are only known at run time and are checked then       */
+    std::vector<std::string> check(const std::string& name)
+    {
+        std::vector<std::string> errors;
+        std::set<std::string> seen;
+        std::vector<std::string> todo{ name };
+        while (!todo.empty()) {
+            std::string n = std::move(todo.back()); todo.pop_back();
+            if (!seen.insert(n).second) continue;
+            ProgramPtr p = program(n);
+            if (!p) { errors.push_back("proc not found: " + path(n).string()); continue; }
+            errors.insert(errors.end(), p->errors.begin(), p->errors.end());
+            for (const Instr& in : p->code) {
+                const size_t k = in.cmd == "loop" ? 1 : in.cmd == "call_proc" ? 0 : SIZE_MAX;
+                if (k < in.ops.size() && !in.ops[k].dyn) todo.push_back(in.ops[k].text);
             }
         }
-    /*──────── rect-aware phrase helpers ───────────*/
-        else if (cmd == "click_phrase_rect") {
-            int x,y,w,h; ss>>x>>y>>w>>h;
-            std::string p; std::getline(ss,p); p=du::trim_quotes(du::trim(p));
-            LOG_EVENT("[run_proc] click_phrase_rect \"%s\"  roi=(%d,%d,%d,%d)\n",
-                      p.c_str(),x,y,w,h);
-            RECT roi{x,y,x+w,y+h};
-            if (auto rc = find_phrase_bbox(ctx.hwnd, roi, p))
-                dw::click(ctx.hwnd,(rc->left+rc->right)/2,(rc->top+rc->bottom)/2);
-            else throw std::runtime_error("click_phrase_rect: not found '"+p+"'");
+        LOG_DEBUG("[run_proc] checked %zu proc(s), %zu problem(s)\n", seen.size(), errors.size());
+        return errors;
+    }
+
+private:
+    struct Entry {
+        std::filesystem::file_time_type mtime;
+        ProgramPtr                      prog;
+    };
+    std::map<std::string, Entry> map_;
+    std::mutex                   mu_;
+};
+
+/* expand $1 … $N ----------------------------------------------------------*/
+inline std::string expand_args(std::string_view line,
+    const std::vector<std::string>& args)
+{
+    return detail::expand(line, args);
+}
+
+inline bool run_proc(Context& ctx, const std::string& name,
+                     const std::vector<std::string>& args = {}, int depth = 0);
+inline bool run_program(Context& ctx, const Program& prog,
+                        const std::vector<std::string>& args, int depth);
+
+/*──────────────────── command handlers ──────────────────*/
+/* what the interpreter does after a command */
+enum class Flow {
+    next,     // following line
+    fail,     // leave the proc with false (loop → next iteration stops)
+    stop      // leave the proc with true
+};
+
+namespace cmd {
+
+/*──────────── flow / tasks ────────────────────*/
+inline Flow loop(Context& ctx, Ops& op, int depth)
+{
+    const int times = int(op.i(0)); const std::string& sub = op.str(1);
+
+    LOG_EVENT("[run_proc] loop  times=%d  sub='%s'\n", times, sub.c_str());
+    if (sub.empty())
+        throw std::runtime_error("loop: missing sub-procedure name");
+    if (times <= 0) return Flow::next;     // nothing to do
+
+    std::vector<std::string> sub_args = op.strs(2);
+    if (depth + 1 > 10) {
+        LOG_ERROR("[run_proc] proc recursion too deep – aborting (%s)\n", sub.c_str());
+        return Flow::next;
+    }
+    ProgramPtr p = ProcCache::get().program(sub);   // once for every iteration
+    if (!p) {
+        LOG_ERROR("[run_proc] proc not found: %s\n", ProcCache::path(sub).string().c_str());
+        return Flow::next;
+    }
+    for (int i = 0; i < times; ++i) {
+        LOG_DEBUG("[run_proc]   ↳ iteration %d/%d\n", i + 1, times);
+        if (!run_program(ctx, *p, sub_args, depth + 1))
+            break;
+    }
+    return Flow::next;
+}
+
+inline Flow call_proc(Context& ctx, Ops& op, int depth)
+{
+    const std::string& sub = op.str(0);
+    std::vector<std::string> sub_args = op.strs(1);
+    LOG_EVENT("[run_proc] call_proc  sub='%s'  argc=%zu\n", sub.c_str(), sub_args.size());
+    return run_proc(ctx, sub, sub_args, depth + 1) ? Flow::next : Flow::fail;
+}
+
+inline Flow call_fn(Context& ctx, Ops& op, int)
+{
+    const std::string& fn = op.str(0);
+    std::vector<std::string> fn_args = op.strs(1);
+
+    LOG_EVENT("[run_proc] call_fn  fn='%s'  argc=%zu\n",
+              fn.c_str(), fn_args.size());
+
+    auto it = FN_TABLE.find(fn);
+    if (it == FN_TABLE.end()) {
+        LOG_ERROR("unknown fn: %s\n", fn.c_str());
+        return Flow::fail;
+    }
+
+    /* invoke; bubble failure up the stack */
+    return (*it->second)(ctx, fn_args) ? Flow::next : Flow::fail;
+}
+
+/*──────────────── basic mouse / kbd ───────────────*/
+inline Flow click(Context& ctx, Ops& op, int)       { int x=int(op.i(0)),y=int(op.i(1)); LOG_EVENT("[run_proc] click (%d,%d)\n",x,y); dw::click(ctx.hwnd,x,y); return Flow::next; }
+inline Flow click_delta(Context& ctx, Ops& op, int) { int x=int(op.i(0)),y=int(op.i(1)),dx=int(op.i(2)),dy=int(op.i(3)); LOG_EVENT("[run_proc] click_delta (%d+%d,%d+%d)\n",x,dx,y,dy); dw::click(ctx.hwnd,x+dx,y+dy); return Flow::next; }
+inline Flow dblclick(Context& ctx, Ops& op, int)    { int x=int(op.i(0)),y=int(op.i(1)); LOG_EVENT("[run_proc] dblclick (%d,%d)\n",x,y); dw::dbl_click(ctx.hwnd,x,y); return Flow::next; }
+inline Flow mouse_move(Context& ctx, Ops& op, int)  { int x=int(op.i(0)),y=int(op.i(1)); LOG_EVENT("[run_proc] move (%d,%d)\n",x,y); dw::move_cursor(ctx.hwnd,x,y); return Flow::next; }
+inline Flow scroll(Context& ctx, Ops& op, int)      { int x=int(op.i(0)),y=int(op.i(1)),d=int(op.i(2)); LOG_EVENT("[run_proc] scroll (%d,%d) d=%d\n",x,y,d); if(d) dw::mouse_wheel(ctx.hwnd,x,y,d); return Flow::next; }
+inline Flow hold_click(Context& ctx, Ops& op, int)
+{
+    int x=int(op.i(0)),y=int(op.i(1)),dur=int(op.i(2));
+    LOG_EVENT("[run_proc] hold_click (%d,%d) dur=%dms\n",x,y,dur);
+    if (dur == 0) return Flow::next;
+    if (dur < 0)  throw std::runtime_error("hold_click duration must be >0");
+    dw::mouse_down(ctx.hwnd,x,y); ::Sleep(dur); dw::mouse_up(ctx.hwnd,x,y);
+    return Flow::next;
+}
+inline Flow type(Context& ctx, Ops& op, int)  { std::string t=op.rest(0); LOG_EVENT("[run_proc] type \"%s\"\n",t.c_str()); dw::send_text(ctx.hwnd,t); return Flow::next; }
+inline Flow key(Context& ctx, Ops& op, int)   { const std::string& k=op.str(0); LOG_EVENT("[run_proc] key \"%s\"\n",k.c_str()); dw::send_vk_infocus(ctx.hwnd,k); return Flow::next; }
+inline Flow paste(Context& ctx, Ops& op, int) { std::string t=op.rest(0); LOG_EVENT("[run_proc] paste \"%s\"\n",t.c_str()); dw::paste(ctx.hwnd,dw::to_wstring(t)); return Flow::next; }
+inline Flow sleep(Context&, Ops& op, int)     { int ms=int(op.i(0)); LOG_EVENT("[run_proc] sleep %dms\n",ms); std::this_thread::sleep_for(std::chrono::milliseconds(ms)); so::invalidate_frame(); return Flow::next; }
+
+/*──────────────── CTX helpers ─────────────────────*/
+inline Flow set_prev(Context& ctx, Ops&, int)
+{
+    LOG_EVENT("[run_proc] set_prev (capture window)\n");
+    ctx.prev = so::frame(ctx.hwnd);
+    return Flow::next;
+}
+inline Flow snapshot(Context& ctx, Ops&, int)
+{
+    LOG_EVENT("[run_proc] snapshot (pin frame until next input)\n");
+    so::snapshot(ctx.hwnd);
+    return Flow::next;
+}
+inline Flow ocr_session(Context& ctx, Ops& op, int)    /* [x y w h] – OCR fields off one frame until input */
+{
+    RECT area = op.size() >= 4 ? op.rect(0) : RECT{};
+    LOG_EVENT("[run_proc] ocr_session (%ld,%ld,%ld,%ld)\n",
+              long(area.left),long(area.top),long(area.right),long(area.bottom));
+    ctx.ocr = so::ocr_session(ctx.hwnd, area);
+    return Flow::next;
+}
+inline Flow ocr_session_end(Context& ctx, Ops&, int)
+{
+    LOG_EVENT("[run_proc] ocr_session_end\n");
+    ctx.ocr.reset();
+    return Flow::next;
+}
+inline Flow set_vars(Context& ctx, Ops& op, int)
+{
+    const std::string &var=op.str(0), &value=op.str(1);
+    LOG_EVENT("[run_proc] set_vars  %s = \"%s\"\n",var.c_str(),value.c_str());
+    ctx.vars[op.slot(0)]=value;
+    return Flow::next;
+}
+inline Flow append_vars(Context& ctx, Ops& op, int)
+{
+    const std::string &var=op.str(0), &value=op.str(1);
+    LOG_EVENT("[run_proc] append_vars  %s = \"%s\"\n",var.c_str(),value.c_str());
+    ctx.vars[op.slot(0)]+=value;
+    return Flow::next;
+}
+
+/*──────────────── OCR helpers ─────────────────────*/
+inline Flow OCR(Context& ctx, Ops& op, int)            /* x y w h into var [profile] */
+{
+    RECT rc=op.rect(0); const std::string &var=op.str(5), &prof=op.str(6);
+    LOG_EVENT("[run_proc] OCR  (%ld,%ld,%ld,%ld) → %s %s\n",long(rc.left),long(rc.top),long(rc.right-rc.left),long(rc.bottom-rc.top),var.c_str(),prof.c_str());
+    ctx.vars[op.slot(5)]=typed(read_field(ctx,rc,prof),prof);
+    return Flow::next;
+}
+inline Flow OCR_batch(Context& ctx, Ops& op, int)      /* x y w h into var[@profile]   x y w h into var … */
+{
+    std::vector<RECT> rois; std::vector<std::string> vars, profs;
+    for (size_t k = 0; k + 6 <= op.size(); k += 6) {
+        const std::string& var = op.str(k + 5);
+        auto at = var.find('@');
+        profs.push_back(at == std::string::npos ? "" : var.substr(at + 1));
+        vars.push_back(var.substr(0, at));
+        rois.push_back(op.rect(k));
+    }
+    LOG_EVENT("[run_proc] OCR_batch  %zu regions\n", rois.size());
+    bool in_session = ctx.ocr && ctx.ocr->frame()->input_seq == dw::input_seq();
+    for (const RECT& r : rois) in_session = in_session && ctx.ocr->covers(r);
+    std::vector<std::string> txt = in_session ? ctx.ocr->read(rois, profs)
+                                              : so::read_regions(ctx.hwnd, rois, profs);
+    for (size_t i = 0; i < vars.size(); ++i) {
+        LOG_DEBUG("[run_proc] OCR_batch  %s = \"%s\"\n", vars[i].c_str(), txt[i].c_str());
+        ctx.vars[vars[i]] = typed(txt[i], profs[i]);
+    }
+    return Flow::next;
+}
+inline Flow OCR_diff(Context& ctx, Ops& op, int)       /* x y w h into var [profile] */
+{
+    RECT rc=op.rect(0); const std::string &var=op.str(5), &prof=op.str(6);
+    LOG_EVENT("[run_proc] OCR_diff (%ld,%ld,%ld,%ld) → %s %s\n",long(rc.left),long(rc.top),long(rc.right-rc.left),long(rc.bottom-rc.top),var.c_str(),prof.c_str());
+    ctx.vars[op.slot(5)]=typed(so::read_region(ctx.hwnd,so::pixels(ctx.prev),rc,prof),prof);
+    return Flow::next;
+}
+inline Flow expect_ocr(Context& ctx, Ops& op, int)
+{
+    RECT rc=op.rect(0); std::string exp=op.rest(4);
+    LOG_EVENT("[run_proc] expect_ocr (%ld,%ld,%ld,%ld) exp=\"%s\"\n",long(rc.left),long(rc.top),long(rc.right-rc.left),long(rc.bottom-rc.top),exp.c_str());
+    std::string txt = read_field(ctx, rc);
+    if (du::simplify(txt).find(du::simplify(exp)) == std::string::npos)
+        throw std::runtime_error("EXPECT_OCR failed. exp='"+exp+"' got='"+txt+"'");
+    return Flow::next;
+}
+inline Flow OCR_append(Context& ctx, Ops& op, int)     /* x y w h into var [profile] */
+{
+    RECT rc=op.rect(0); const std::string &var=op.str(5), &prof=op.str(6);
+    LOG_EVENT("[run_proc] OCR  (%ld,%ld,%ld,%ld) → %s %s\n",long(rc.left),long(rc.top),long(rc.right-rc.left),long(rc.bottom-rc.top),var.c_str(),prof.c_str());
+    ctx.vars[op.slot(5)]+=read_field(ctx,rc,prof);
+    return Flow::next;
+}
+inline Flow ocr_break(Context& ctx, Ops& op, int)
+{
+    RECT rc=op.rect(0); std::string exp=op.rest(4);
+    LOG_DEBUG("[run_proc] ocr_break (%ld,%ld,%ld,%ld) exp=\"%s\"\n",long(rc.left),long(rc.top),long(rc.right-rc.left),long(rc.bottom-rc.top),exp.c_str());
+    std::string txt = read_field(ctx, rc);
+    if (du::simplify(txt).find(du::simplify(exp)) != std::string::npos){
+        LOG_EVENT("[run_proc] ocr_break break!\n");
+        return Flow::fail;
+    }
+    LOG_EVENT("[run_proc] ocr_break NO break!\n");
+    return Flow::next;
+}
+inline Flow ocr_stop(Context& ctx, Ops& op, int)
+{
+    RECT rc=op.rect(0); std::string exp=op.rest(4);
+    LOG_DEBUG("[run_proc] ocr_stop (%ld,%ld,%ld,%ld) exp=\"%s\"\n",long(rc.left),long(rc.top),long(rc.right-rc.left),long(rc.bottom-rc.top),exp.c_str());
+    std::string txt = read_field(ctx, rc);
+    if (du::simplify(txt).find(du::simplify(exp)) != std::string::npos){
+        LOG_EVENT("[run_proc] ocr_stop stop!\n");
+        return Flow::stop;
+    }
+    LOG_EVENT("[run_proc] ocr_stop NO stop!\n");
+    return Flow::next;
+}
+
+/*──────────── diff-based break/stop ───────────*/
+inline Flow break_if_no_diff(Context& ctx, Ops& op, int)
+{
+    RECT rc=op.rect(0);
+    double c = so::compare_imag(ctx.hwnd, ctx.prev, rc);
+    LOG_DEBUG("[run_proc] break_if_no_diff cmp=%f\n", c);
+    if (c > CFG_DBL("diff_comparison_humbral", 0.5)) {
+        LOG_EVENT("[run_proc] break_if_no_diff break!\n");
+        return Flow::fail;
+    }
+    LOG_EVENT("[run_proc] break_if_no_diff NO break!\n");
+    return Flow::next;
+}
+inline Flow stop_if_no_diff(Context& ctx, Ops& op, int)
+{
+    RECT rc=op.rect(0);
+    double c = so::compare_imag(ctx.hwnd, ctx.prev, rc);
+    LOG_DEBUG("[run_proc] stop_if_no_diff cmp=%f\n", c);
+    if (c > CFG_DBL("diff_comparison_humbral", 0.5)){
+        LOG_EVENT("[run_proc] stop_if_no_diff stop!\n");
+        return Flow::stop;
+    }
+    LOG_EVENT("[run_proc] stop_if_no_diff NO stop!\n");
+    return Flow::next;
+}
+
+/*──────── phrase helpers ───────────*/
+inline Flow click_phrase(Context& ctx, Ops& op, int)
+{
+    std::string p=op.rest(0);
+    LOG_EVENT("[run_proc] click_phrase \"%s\"\n",p.c_str());
+    if (auto rc = find_phrase_bbox(ctx.hwnd,p))
+        dw::click(ctx.hwnd,(rc->left+rc->right)/2,(rc->top+rc->bottom)/2);
+    else throw std::runtime_error("click_phrase: not found '"+p+"'");
+    return Flow::next;
+}
+inline Flow wait_phrase(Context& ctx, Ops& op, int)
+{
+    const std::string& p=op.str(0); int to=int(op.i(1));
+    LOG_EVENT("[run_proc] wait_phrase \"%s\"  timeout=%dms\n",p.c_str(),to);
+    static const int ocr_ms = CFG_INT("wait_phrase_ocr_ms", 200);
+    auto start = std::chrono::steady_clock::now(), last_ocr = start;
+    so::FramePtr seen; Backoff bo;              // OCR again only once the window changed
+    int ocrs = 0;
+    while (ms_since(start) < to) {
+        so::FramePtr now = so::frame(ctx.hwnd);     // one capture per poll: compared, then read
+        if (!seen || so::roi_changed(*seen, *now, now->rc)) {
+            seen = now;
+            last_ocr = std::chrono::steady_clock::now(); ++ocrs;
+            if (find_phrase_bbox(now, p)) break;
         }
-        else if (cmd == "wait_phrase_rect") {
-            int x,y,w,h; ss>>x>>y>>w>>h;
-            std::string p; int to; ss>>std::quoted(p)>>to;
-            LOG_EVENT("[run_proc] wait_phrase_rect \"%s\" roi=(%d,%d,%d,%d) timeout=%dms\n",
-                      p.c_str(),x,y,w,h,to);
-            RECT roi{x,y,x+w,y+h};
-            auto start = std::chrono::steady_clock::now();
-            while (std::chrono::steady_clock::now()-start < std::chrono::milliseconds(to)) {
-                if (find_phrase_bbox(ctx.hwnd, roi, p)) break;
-                std::this_thread::sleep_for(std::chrono::milliseconds(200));
-            }
+        bo.sleep(ocr_ms - ms_since(last_ocr));      // never OCR more often than ocr_ms
+    }
+    LOG_DEBUG("[run_proc] wait_phrase %dms, %d poll(s), %d OCR pass(es)\n", ms_since(start), bo.polls(), ocrs);
+    return Flow::next;
+}
+inline Flow locate_phrases(Context& ctx, Ops& op, int)   /* [x y w h] var "phrase" var "phrase" … */
+{
+    RECT roi{}; size_t k = 0;
+    if (op.size() >= 4 && op.is_num(0) && op.is_num(1) && op.is_num(2) && op.is_num(3)) { roi = op.rect(0); k = 4; }
+    std::vector<std::string> vars, phrases;
+    for (; k + 2 <= op.size(); k += 2) { vars.push_back(op.str(k)); phrases.push_back(op.str(k + 1)); }
+    LOG_EVENT("[run_proc] locate_phrases  %zu phrase(s)  roi=(%ld,%ld,%ld,%ld)\n", phrases.size(),
+              long(roi.left),long(roi.top),long(roi.right),long(roi.bottom));
+    auto hits = so::locate_many(ctx.hwnd, roi,
+                    std::vector<std::string_view>(phrases.begin(), phrases.end()));
+    /* var = "cx cy" of the first box ("" when absent), var_n = box count */
+    for (size_t i = 0; i < vars.size(); ++i) {
+        const std::vector<RECT>& b = hits[phrases[i]];
+        ctx.vars[vars[i]] = b.empty() ? "" : std::to_string((b[0].left+b[0].right)/2) + " "
+                                           + std::to_string((b[0].top+b[0].bottom)/2);
+        ctx.vars[vars[i] + "_n"] = std::to_string(b.size());
+        LOG_EVENT("[run_proc] locate_phrases  %s = \"%s\"  (%zu box(es))\n",
+                  vars[i].c_str(), ctx.vars[vars[i]].text().c_str(), b.size());
+    }
+    return Flow::next;
+}
+inline Flow click_var(Context& ctx, Ops& op, int)        /* var holding "x y" (locate_phrases) */
+{
+    const std::string& var=op.str(0);
+    const Value* v = ctx.vars.find(var);
+    std::istringstream xy(v ? v->text() : std::string()); int x,y;
+    if (!(xy>>x>>y)) throw std::runtime_error("click_var: no coordinates in '"+var+"'");
+    LOG_EVENT("[run_proc] click_var %s (%d,%d)\n",var.c_str(),x,y);
+    dw::click(ctx.hwnd,x,y);
+    return Flow::next;
+}
+
+/*──────── fixed-art widgets (template_dir) ───────────*/
+inline Flow click_template(Context& ctx, Ops& op, int)   /* name [x y w h] */
+{
+    const std::string& name=op.str(0);
+    RECT roi = op.size() >= 5 ? op.rect(1) : RECT{};
+    LOG_EVENT("[run_proc] click_template %s\n",name.c_str());
+    if (auto hit = so::locate_template(ctx.hwnd, name, roi))
+        dw::click(ctx.hwnd,(hit->box.left+hit->box.right)/2,(hit->box.top+hit->box.bottom)/2);
+    else throw std::runtime_error("click_template: not found '"+name+"'");
+    return Flow::next;
+}
+inline Flow wait_template(Context& ctx, Ops& op, int)    /* name timeout [x y w h] */
+{
+    const std::string& name=op.str(0); int to=int(op.i(1));
+    RECT roi = op.size() >= 6 ? op.rect(2) : RECT{};
+    LOG_EVENT("[run_proc] wait_template %s  timeout=%dms\n",name.c_str(),to);
+    auto start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now()-start < std::chrono::milliseconds(to)) {
+        if (so::locate_template(ctx.hwnd, name, roi)) break;
+        so::invalidate_frame();       // frames grabbed during the sleep qualify
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    return Flow::next;
+}
+
+/*──────── rect-aware phrase helpers ───────────*/
+inline Flow click_phrase_rect(Context& ctx, Ops& op, int)
+{
+    RECT roi=op.rect(0); std::string p=op.rest(4);
+    LOG_EVENT("[run_proc] click_phrase_rect \"%s\"  roi=(%ld,%ld,%ld,%ld)\n",
+              p.c_str(),long(roi.left),long(roi.top),long(roi.right-roi.left),long(roi.bottom-roi.top));
+    if (auto rc = find_phrase_bbox(ctx.hwnd, roi, p))
+        dw::click(ctx.hwnd,(rc->left+rc->right)/2,(rc->top+rc->bottom)/2);
+    else throw std::runtime_error("click_phrase_rect: not found '"+p+"'");
+    return Flow::next;
+}
+inline Flow wait_phrase_rect(Context& ctx, Ops& op, int)
+{
+    RECT roi=op.rect(0); const std::string& p=op.str(4); int to=int(op.i(5));
+    LOG_EVENT("[run_proc] wait_phrase_rect \"%s\" roi=(%ld,%ld,%ld,%ld) timeout=%dms\n",
+              p.c_str(),long(roi.left),long(roi.top),long(roi.right-roi.left),long(roi.bottom-roi.top),to);
+    static const int ocr_ms = CFG_INT("wait_phrase_ocr_ms", 200);
+    auto start = std::chrono::steady_clock::now(), last_ocr = start;
+    so::FramePtr seen; Backoff bo;              // OCR again only once the roi changed
+    int ocrs = 0;
+    while (ms_since(start) < to) {
+        so::FramePtr now = so::frame(ctx.hwnd, roi);    // one capture per poll: compared, then read
+        if (!now) break;                                // roi off the client area
+        if (!seen || so::roi_changed(*seen, *now, now->rc)) {
+            seen = now;
+            last_ocr = std::chrono::steady_clock::now(); ++ocrs;
+            if (find_phrase_bbox(now, p)) break;
         }
+        bo.sleep(ocr_ms - ms_since(last_ocr));      // never OCR more often than ocr_ms
+    }
+    LOG_DEBUG("[run_proc] wait_phrase_rect %dms, %d poll(s), %d OCR pass(es)\n", ms_since(start), bo.polls(), ocrs);
+    return Flow::next;
+}
 
-    /*──────── save all vars ───────────*/
-        else if (cmd == "save") {
-            std::string path, fname;    int reset = 0;
-            if (!(ss >> std::quoted(path) >> std::quoted(fname) >> reset)) { throw std::runtime_error("save: expected args: \"<path>\" \"<filename>\" <resetFlag>"); }
-            std::string fullpath = path;
-            if (!fullpath.empty() && fullpath.back() != '/' && fullpath.back() != '\\')
-                fullpath += '/';
-            fullpath += fname;
-            if (fname == "random" || fname == "\"random\"")
-                fullpath = path + "/" + du::random_hex();
-            fullpath += ".json";
-            LOG_EVENT("[run_proc] save  \"%s\"  reset=%d  vars=%zu\n",  fullpath.c_str(), reset, ctx.vars.size());
-            std::ofstream out(fullpath);
-            if (!out)   throw std::runtime_error("save: cannot open '" + fullpath + "'");
-            out << "{\n";
-            size_t n = 0, total = ctx.vars.size();
-            for (auto& [k, v] : ctx.vars) {
-                out << "  \"" << du::jesc(k) << "\" : \"" << du::jesc(v) << "\"";   if (++n < total) out << ',';    out << "\n";
-                LOG_EVENT("[run_proc] saved \033[92m\"%s\" = \"%s\"\033[0m\n",k.c_str(), v.c_str());
-            }   out << "}\n";
-        
-            if (reset)  ctx.vars.clear();
+/*──────── waits on screen change ───────────*/
+/* x y w h timeout – until the region differs from set_prev (or from the
+   screen when the command starts) and then holds still wait_settle_ms;
+   replaces the worst-case sleep before break_if_no_diff                 */
+inline Flow wait_change(Context& ctx, Ops& op, int)
+{
+    RECT rc=op.rect(0); int to=int(op.i(4));
+    static const int settle = CFG_INT("wait_settle_ms", 50);
+    auto start = std::chrono::steady_clock::now();
+    so::FramePtr base = so::frame(ctx.hwnd, rc);
+    if (!base) {
+        LOG_WARN("[run_proc] wait_change (%ld,%ld,%ld,%ld) outside the window\n",
+                 long(rc.left),long(rc.top),long(rc.right-rc.left),long(rc.bottom-rc.top));
+        return Flow::next;
+    }
+    if (ctx.prev) base = ctx.prev;
+    Backoff bo;
+    int changed_at = -1, last_move = -1;
+    while (ms_since(start) < to) {
+        if (region_changed(ctx.hwnd, base, rc)) {
+            last_move = ms_since(start);
+            if (changed_at < 0) changed_at = last_move;
+            base = so::frame(ctx.hwnd, rc);          // settle: watch for the next move
+            bo.reset();
         }
-    
+        if (changed_at >= 0 && ms_since(start) - last_move >= settle) break;
+        bo.sleep();
+    }
+    if (changed_at < 0)
+        LOG_EVENT("[run_proc] wait_change (%ld,%ld,%ld,%ld) no change in %dms\n",
+                  long(rc.left),long(rc.top),long(rc.right-rc.left),long(rc.bottom-rc.top),to);
+    else
+        LOG_EVENT("[run_proc] wait_change (%ld,%ld,%ld,%ld) changed after %dms, settled after %dms (%d poll(s))\n",
+                  long(rc.left),long(rc.top),long(rc.right-rc.left),long(rc.bottom-rc.top),
+                  changed_at, ms_since(start), bo.polls());
+    return Flow::next;
+}
 
-    /*──────────── Default ────────────────────*/
-        else {
-            LOG_ERROR("[run_proc] unknown command @%d : %s\n", lineno, cmd.c_str());
-            throw std::runtime_error("unknown command @" + std::to_string(lineno) + cmd + "\n");
-            return false;
+/* x y w h quiet_ms timeout – until the region has not changed for quiet_ms */
+inline Flow wait_stable(Context& ctx, Ops& op, int)
+{
+    RECT rc=op.rect(0); int quiet=int(op.i(4)), to=int(op.i(5));
+    auto start = std::chrono::steady_clock::now();
+    so::FramePtr last = so::frame(ctx.hwnd, rc);
+    if (!last) {
+        LOG_WARN("[run_proc] wait_stable (%ld,%ld,%ld,%ld) outside the window\n",
+                 long(rc.left),long(rc.top),long(rc.right-rc.left),long(rc.bottom-rc.top));
+        return Flow::next;
+    }
+    Backoff bo;
+    int last_move = 0, moves = 0;
+    while (ms_since(start) - last_move < quiet && ms_since(start) < to) {
+        bo.sleep();
+        if (region_changed(ctx.hwnd, last, rc)) {
+            last = so::frame(ctx.hwnd, rc);
+            last_move = ms_since(start);
+            ++moves;
+            bo.reset();
         }
     }
+    const bool stable = ms_since(start) - last_move >= quiet;
+    LOG_EVENT("[run_proc] wait_stable (%ld,%ld,%ld,%ld) %s after %dms (%d change(s), %d poll(s))\n",
+              long(rc.left),long(rc.top),long(rc.right-rc.left),long(rc.bottom-rc.top),
+              stable ? "stable" : "still moving", ms_since(start), moves, bo.polls());
+    return Flow::next;
+}
+
+/*──────── save all vars ───────────*/
+/* results_sink=jsonl (default): one line per save in the folder's run file
+   (dsink.hpp), the file name kept as "_id". results_sink=files: one
+   pretty-printed <path>/<fname>.json per save, as before.               */
+inline Flow save(Context& ctx, Ops& op, int)
+{
+    const std::string &path=op.str(0), &fname=op.str(1); int reset=int(op.i(2));
+    const std::string id = fname == "random" ? du::random_hex() : fname;
+
+    static const bool to_files = CFG_STR("results_sink", "jsonl") == "files";
+    if (!to_files) {
+        ds::Sink* sink = ds::Sinks::get().folder(path, CFG_INT("sink_sync_ms", 1000));
+        if (!sink) throw std::runtime_error("save: cannot open the results file in '" + path + "'");
+        std::string line = "{\"_id\":\"" + du::jesc(id) + "\"";
+        ctx.vars.for_each([&](const std::string& k, const Value& v) {
+            line += ",\"" + du::jesc(k) + "\":" + v.json();
+        });
+        line += '}';
+        LOG_EVENT("[run_proc] save  %s  reset=%d  vars=%zu\n", line.c_str(), reset, ctx.vars.size());
+        sink->append(std::move(line));
+        if (reset)  ctx.vars.clear();
+        return Flow::next;
+    }
+
+    std::string fullpath = path;
+    if (!fullpath.empty() && fullpath.back() != '/' && fullpath.back() != '\\')
+        fullpath += '/';
+    fullpath += id;
+    fullpath += ".json";
+    LOG_EVENT("[run_proc] save  \"%s\"  reset=%d  vars=%zu\n",  fullpath.c_str(), reset, ctx.vars.size());
+    std::ofstream out(fullpath);
+    if (!out)   throw std::runtime_error("save: cannot open '" + fullpath + "'");
+    out << "{\n";
+    size_t n = 0, total = ctx.vars.size();
+    ctx.vars.for_each([&](const std::string& k, const Value& v) {
+        out << "  \"" << du::jesc(k) << "\" : " << v.json();   if (++n < total) out << ',';    out << "\n";
+        LOG_EVENT("[run_proc] saved \033[92m\"%s\" = %s\033[0m\n",k.c_str(), v.json().c_str());
+    }); out << "}\n";
+
+    if (reset)  ctx.vars.clear();
+    return Flow::next;
+}
+
+} // namespace cmd
+
+/*──────────────────── command table ─────────────────────*/
+using Handler = Flow(*)(Context&, Ops&, int depth);
+
+/* one .proc command: operand count and, per leading position, its kind –
+   'i' number, 'v' variable name (interned), 's' anything. Checked when a
+   proc is compiled.                                                       */
+struct Command {
+    const char* name;
+    Handler     fn;
+    int         min_args;
+    int         max_args;        // -1 = no limit
+    const char* kinds;
+};
+
+static const Command COMMANDS[] = {
+    /* flow / tasks */
+    { "loop",              &cmd::loop,              2, -1, "is"      },
+    { "call_proc",         &cmd::call_proc,         1, -1, "s"       },
+    { "call_fn",           &cmd::call_fn,           1, -1, "s"       },
+    /* mouse / keyboard */
+    { "click",             &cmd::click,             2,  2, "ii"      },
+    { "click_delta",       &cmd::click_delta,       4,  4, "iiii"    },
+    { "dblclick",          &cmd::dblclick,          2,  2, "ii"      },
+    { "move",              &cmd::mouse_move,        2,  2, "ii"      },
+    { "scroll",            &cmd::scroll,            3,  3, "iii"     },
+    { "hold_click",        &cmd::hold_click,        3,  3, "iii"     },
+    { "type",              &cmd::type,              1, -1, ""        },
+    { "key",               &cmd::key,               1,  1, "s"       },
+    { "paste",             &cmd::paste,             1, -1, ""        },
+    { "sleep",             &cmd::sleep,             1,  1, "i"       },
+    /* context */
+    { "set_prev",          &cmd::set_prev,          0,  0, ""        },
+    { "snapshot",          &cmd::snapshot,          0,  0, ""        },
+    { "ocr_session",       &cmd::ocr_session,       0,  4, "iiii"    },
+    { "ocr_session_end",   &cmd::ocr_session_end,   0,  0, ""        },
+    { "set_vars",          &cmd::set_vars,          2,  2, "vs"      },
+    { "append_vars",       &cmd::append_vars,       2,  2, "vs"      },
+    /* OCR */
+    { "OCR",               &cmd::OCR,               6,  7, "iiiisv"  },
+    { "OCR_batch",         &cmd::OCR_batch,         6, -1, "iiiiss"  },
+    { "OCR_diff",          &cmd::OCR_diff,          6,  7, "iiiisv"  },
+    { "OCR_append",        &cmd::OCR_append,        6,  7, "iiiisv"  },
+    { "expect_ocr",        &cmd::expect_ocr,        5, -1, "iiii"    },
+    { "ocr_break",         &cmd::ocr_break,         5, -1, "iiii"    },
+    { "ocr_stop",          &cmd::ocr_stop,          5, -1, "iiii"    },
+    /* image diff */
+    { "break_if_no_diff",  &cmd::break_if_no_diff,  4,  4, "iiii"    },
+    { "stop_if_no_diff",   &cmd::stop_if_no_diff,   4,  4, "iiii"    },
+    { "wait_change",       &cmd::wait_change,       5,  5, "iiiii"   },
+    { "wait_stable",       &cmd::wait_stable,       6,  6, "iiiiii"  },
+    /* phrases */
+    { "click_phrase",      &cmd::click_phrase,      1, -1, ""        },
+    { "wait_phrase",       &cmd::wait_phrase,       2,  2, "si"      },
+    { "locate_phrases",    &cmd::locate_phrases,    2, -1, ""        },
+    { "click_var",         &cmd::click_var,         1,  1, "v"       },
+    { "click_phrase_rect", &cmd::click_phrase_rect, 5, -1, "iiii"    },
+    { "wait_phrase_rect",  &cmd::wait_phrase_rect,  6,  6, "iiiisi"  },
+    /* widgets */
+    { "click_template",    &cmd::click_template,    1,  5, "siiii"   },
+    { "wait_template",     &cmd::wait_template,     2,  6, "siiiii"  },
+    /* output */
+    { "save",              &cmd::save,              3,  3, "ssi"     },
+};
+
+/* command name → index into COMMANDS, -1 when unknown */
+inline int opcode(std::string_view name)
+{
+    static const std::unordered_map<std::string_view, int> index = [] {
+        std::unordered_map<std::string_view, int> m;
+        for (size_t i = 0; i < std::size(COMMANDS); ++i) m.emplace(COMMANDS[i].name, int(i));
+        return m;
+    }();
+    auto it = index.find(name);
+    return it == index.end() ? -1 : it->second;
+}
+
+namespace detail {
+/* operand problems of one line against its command, "" when fine */
+inline std::string check_operands(const Instr& in, const Command& c)
+{
+    const int n = int(in.ops.size());
+    if (n < c.min_args || (c.max_args >= 0 && n > c.max_args))
+        return in.cmd + ": expected " + std::to_string(c.min_args)
+             + (c.max_args == c.min_args ? "" : c.max_args < 0 ? "+" : "-" + std::to_string(c.max_args))
+             + " operand(s), got " + std::to_string(n);
+    for (size_t k = 0; c.kinds[k] && k < in.ops.size(); ++k) {
+        const Operand& o = in.ops[k];
+        if (c.kinds[k] == 'i' && !o.dyn && !o.num)
+            return in.cmd + ": operand " + std::to_string(k + 1) + " '" + o.text + "' is not a number";
+    }
+    if (in.cmd == "call_fn" && !in.ops[0].dyn && FN_TABLE.find(in.ops[0].text) == FN_TABLE.end())
+        return "call_fn: unknown fn '" + in.ops[0].text + "'";
+    return {};
+}
+} // namespace detail
+
+inline Program compile(const std::string& name, const std::vector<std::string>& lines)
+{
+    Program p;
+    p.name = name;
+    int lineno = 0;
+    for (std::string raw : lines) {
+        ++lineno;
+        if (auto pos = raw.find('#'); pos != std::string::npos) raw.erase(pos);
+        raw = du::trim(raw);
+        if (raw.empty()) continue;
+        Instr in = detail::compile_line(raw, lineno);
+        in.op = opcode(in.cmd);
+        std::string err = in.op < 0 ? "unknown command '" + in.cmd + "'"
+                                    : detail::check_operands(in, COMMANDS[in.op]);
+        if (in.op >= 0)
+            for (size_t k = 0; COMMANDS[in.op].kinds[k] && k < in.ops.size(); ++k)
+                if (COMMANDS[in.op].kinds[k] == 'v' && !in.ops[k].dyn)
+                    in.ops[k].slot = Symbols::get().intern(in.ops[k].text);
+        if (!err.empty()) p.errors.push_back(name + ":" + std::to_string(lineno) + ": " + err);
+        p.code.push_back(std::move(in));
+    }
+    return p;
+}
+
+/*──────────────────── core interpreter ──────────────────*/
+inline bool run_proc(Context& ctx,
+                     const std::string&              name,
+                     const std::vector<std::string>& args,
+                     int                              depth)
+{
+    /*── entry ───────────────────────────────────────────*/
+    LOG_EVENT("[run_proc] run_proc  name='%s'  depth=%d  argc=%zu\n",
+              name.c_str(), depth, args.size());
+
+    if (depth > 10) {
+        LOG_ERROR("[run_proc] proc recursion too deep – aborting (%s)\n", name.c_str());
+        return false;
+    }
+
+    ProgramPtr prog = ProcCache::get().program(name);
+    if (!prog) {
+        LOG_ERROR("[run_proc] proc not found: %s\n", ProcCache::path(name).string().c_str());
+        return false;
+    }
+    return run_program(ctx, *prog, args, depth);
+}
+
+inline bool run_program(Context& ctx, const Program& prog,
+                        const std::vector<std::string>& args, int depth)
+{
+    const std::string& name = prog.name;
+    if (!prog.errors.empty()) {                // procs named through $N land here unchecked
+        for (const std::string& e : prog.errors) LOG_ERROR("[run_proc] %s\n", e.c_str());
+        throw std::runtime_error("proc '" + name + "' does not compile");
+    }
+
+    /*── main instruction loop ───────────────────────────*/
+    for (const Instr& in : prog.code)
+    {
+        Ops op(in, args);
+        LOG_DEBUG("[run_proc] [%s:%d] %s\n", name.c_str(), in.line, in.src.c_str());
+
+        so::FrameCache::get().next_step();     // new step → new frame (unless pinned)
+
+        if (dr::session().is_open()) dr::session().command(op.line(), dw::input_seq());
+
+        const Flow f = COMMANDS[in.op].fn(ctx, op, depth);
+        if (f == Flow::fail) return false;
+        if (f == Flow::stop) break;
+    }
 
     LOG_EVENT("[run_proc] proc '%s' completed successfully\n", name.c_str());
     return true;
@@ -6,6 +6,7 @@
 #include "dutils.hpp"       // du::trim / trim_quotes / simplify
 #include "dwin_api.hpp"     // dw::* helpers
 #include "dscreen_ocr.hpp"  // so::read_region / locate_text
+#include "dtemplate.hpp"    // so::locate_template
 #include <opencv2/opencv.hpp>
 #include <optional>
 #include <opencv2/imgproc.hpp>
@@ -14,63 +15,137 @@
 #include <cmath>  // for std::abs
 #include <algorithm>
 #include <thread>
+#include <array>
+#include <map>
+#include <climits>
 
 namespace dp_fn {
 
-/// Fast centre-finder for the orange band.
-/// Down-scales the ROI, does the same HSV / morphology logic,
-/// then rescales the centroid to original coords.
-inline std::optional<cv::Point>
-find_orange_box_center(const cv::Mat& region)
-{
-    CV_Assert(region.type() == CV_8UC3 || region.type() == CV_8UC4);
-
-    /* 0. Build a small thumbnail ------------------------------------------------ */
-    constexpr double SCALE = 0.25;                // 25 %  (tweak if needed)
-    cv::Mat small;
-    cv::resize(region, small, cv::Size(), SCALE, SCALE, cv::INTER_AREA);
-
-    /* 1.  Ensure 3-channel BGR --------------------------------------------------- */
-    if (small.channels() == 4)
-        cv::cvtColor(small, small, cv::COLOR_BGRA2BGR);
-
-    /* 2.  HSV thresholding (same numbers) --------------------------------------- */
-    cv::Mat hsv;
-    cv::cvtColor(small, hsv, cv::COLOR_BGR2HSV_FULL);
+/*────────────────── orange selection band ──────────────────*/
+/* Last band seen in one finder rectangle; the next lookup scans a narrow
+   window around it (and the row below) before the whole region.        */
+struct BandTrack {
+    int top = -1, bottom = -1;    // region rows, -1 = nothing yet
+    int pitch = 0;                // last observed move, rows
+};
 
-    const cv::Scalar lo(10, 100,   0);
-    const cv::Scalar hi(40, 255, 255);
+/* one tracker per finder rectangle */
+inline BandTrack& band_track(const RECT& finder)
+{
+    static std::map<std::array<LONG, 4>, BandTrack> t;
+    return t[{ finder.left, finder.top, finder.right, finder.bottom }];
+}
 
-    cv::Mat mask;
-    cv::inRange(hsv, lo, hi, mask);
+namespace detail {
+/* HSV_FULL hue 10..40, saturation ≥ 100 (the old inRange numbers) for every
+   5-bit-per-channel BGR colour, computed once                            */
+inline const std::array<uint8_t, 1 << 15>& orange_lut()
+{
+    static const std::array<uint8_t, 1 << 15> lut = [] {
+        std::array<uint8_t, 1 << 15> t{};
+        for (int k = 0; k < (1 << 15); ++k) {
+            const int b = ((k >> 10) & 31) * 8 + 4, g = ((k >> 5) & 31) * 8 + 4, r = (k & 31) * 8 + 4;
+            const int mx = std::max({ b, g, r }), d = mx - std::min({ b, g, r });
+            if (d == 0) continue;
+            const int sat = (255 * d + mx / 2) / mx;
+            double h = mx == r ? 60.0 * (g - b) / d
+                     : mx == g ? 120.0 + 60.0 * (b - r) / d
+                     :           240.0 + 60.0 * (r - g) / d;
+            if (h < 0) h += 360.0;
+            const int hue = int(h * 256.0 / 360.0 + 0.5) & 255;
+            t[k] = hue >= 10 && hue <= 40 && sat >= 100;
+        }
+        return t;
+    }();
+    return lut;
+}
 
-    /* morphological clean-up (kernels scaled with the thumbnail) */
-    auto kOpen  = cv::getStructuringElement(
-                      cv::MORPH_RECT, {std::max(3, int(5  * SCALE)),
-                                       std::max(2, int(3  * SCALE))});
-    auto kClose = cv::getStructuringElement(
-                      cv::MORPH_RECT, {std::max(5, int(25 * SCALE)),
-                                       std::max(3, int(5  * SCALE))});
+struct Band { int top, bottom, left, right; };   // region coords, inclusive
 
-    cv::morphologyEx(mask, mask, cv::MORPH_OPEN,  kOpen);
-    cv::morphologyEx(mask, mask, cv::MORPH_CLOSE, kClose);
+/* rows [y0, y1) of a BGR(A) region: pixels → LUT → row / column projections
+   on a 2-px lattice; the band is the run of dense rows around the densest */
+inline std::optional<Band> orange_band(const cv::Mat& region, int y0, int y1)
+{
+    constexpr int STEP = 2;
+    const auto& lut = orange_lut();
+    const int ch = region.channels();
+    const int cols = (region.cols + STEP - 1) / STEP;
+    y0 = std::max(0, y0) / STEP * STEP;
+    y1 = std::min(region.rows, y1);
+    if (y1 - y0 < STEP) return std::nullopt;
+
+    auto orange = [&](const uint8_t* p) {
+        return lut[(p[0] >> 3) << 10 | (p[1] >> 3) << 5 | (p[2] >> 3)];
+    };
 
-    /* 3.  Largest contour → moments → centre ------------------------------------ */
-    std::vector<std::vector<cv::Point>> cc;
-    cv::findContours(mask, cc, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
-    if (cc.empty()) return std::nullopt;
+    /* 1. row projection */
+    std::vector<int> rows;
+    for (int y = y0; y < y1; y += STEP) {
+        const uint8_t* p = region.ptr<uint8_t>(y);
+        int n = 0;
+        for (int x = 0; x < region.cols; x += STEP) n += orange(p + x * ch);
+        rows.push_back(n);
+    }
+    const int peak = int(std::max_element(rows.begin(), rows.end()) - rows.begin());
+    if (rows[peak] < std::max(8, cols / 10)) return std::nullopt;     // nothing band-wide
+
+    const int dense = rows[peak] / 2;
+    int r0 = peak, r1 = peak;
+    while (r0 > 0 && rows[r0 - 1] >= dense) --r0;
+    while (r1 + 1 < int(rows.size()) && rows[r1 + 1] >= dense) ++r1;
+    if (r1 - r0 + 1 < 3) return std::nullopt;                          // a line, not a band
+
+    /* 2. column projection inside the band rows */
+    std::vector<int> colv(cols, 0);
+    for (int r = r0; r <= r1; ++r) {
+        const uint8_t* p = region.ptr<uint8_t>(y0 + r * STEP);
+        for (int x = 0, c = 0; x < region.cols; x += STEP, ++c) colv[c] += orange(p + x * ch);
+    }
+    const int half = (r1 - r0 + 1) / 2;
+    int best0 = -1, best1 = -2;
+    for (int c = 0; c < cols;) {                                      // longest dense run
+        if (colv[c] < half) { ++c; continue; }
+        int e = c;
+        while (e + 1 < cols && colv[e + 1] >= half) ++e;
+        if (e - c > best1 - best0) { best0 = c; best1 = e; }
+        c = e + 1;
+    }
+    if (best0 < 0) return std::nullopt;
 
-    auto big = std::max_element(cc.begin(), cc.end(),
-                [](auto& a, auto& b){ return cv::contourArea(a) < cv::contourArea(b); });
+    return Band{ y0 + r0 * STEP, y0 + r1 * STEP + STEP - 1,
+                 best0 * STEP,   std::min(region.cols - 1, best1 * STEP + STEP - 1) };
+}
+} // namespace detail
 
-    cv::Moments m = cv::moments(*big);
-    if (m.m00 == 0) return std::nullopt;
+/// Centre of the orange selection band in `region`.
+/// BGRA pixels go straight through a colour LUT into row / column
+/// projections (no resize, colour conversion, morphology or contours).
+/// With a tracker the expected rows are scanned first.
+inline std::optional<cv::Point>
+find_orange_box_center(const cv::Mat& region, BandTrack* track = nullptr)
+{
+    CV_Assert(region.type() == CV_8UC3 || region.type() == CV_8UC4);
 
-    cv::Point centre_small{ int(m.m10 / m.m00), int(m.m01 / m.m00) };
+    std::optional<detail::Band> band;
+    if (track && track->top >= 0) {
+        const int h  = track->bottom - track->top + 1;
+        const int y0 = track->top - h;
+        const int y1 = track->bottom + std::max(std::abs(track->pitch), h) + h + 1;
+        band = detail::orange_band(region, y0, y1);
+        /* clipped by the window → not the whole band, rescan everything */
+        if (band && ((band->top <= std::max(0, y0) + 1 && y0 > 0)
+                  || (band->bottom >= std::min(region.rows, y1) - 2 && y1 < region.rows)))
+            band.reset();
+        LOG_DEBUG("[orange] window rows %d..%d → %s\n", y0, y1, band ? "hit" : "miss");
+    }
+    if (!band) band = detail::orange_band(region, 0, region.rows);
+    if (!band) return std::nullopt;
 
-    /* 4.  Map back to full resolution ------------------------------------------- */
-    return cv::Point{ int(std::round(centre_small.x / SCALE)),
-                      int(std::round(centre_small.y / SCALE)) };
+    if (track) {
+        if (track->top >= 0 && band->top != track->top) track->pitch = band->top - track->top;
+        track->top = band->top; track->bottom = band->bottom;
+    }
+    return cv::Point{ (band->left + band->right + 1) / 2, (band->top + band->bottom + 1) / 2 };
 }
 
 /* Prototype every intrinsic here */
@@ -105,11 +180,13 @@ bool click_next_item_in_line(Context& ctx,
               offset_x, offset_y);
 
     /* grab the sub-image that contains the orange bar */
-    cv::Mat full  = so::detail::capture(ctx.hwnd);
-    cv::Mat sub   = full(cv::Rect(finder_rc.left,  finder_rc.top,
-                                  finder_rc.right - finder_rc.left,
-                                  finder_rc.bottom - finder_rc.top));
-    auto centre = find_orange_box_center(sub);
+    so::FramePtr finder = so::frame(ctx.hwnd, finder_rc);
+    if (!finder) {
+        LOG_ERROR("[call_fn] click_next_item_in_line → finder outside the window\n");
+        return false;
+    }
+    const cv::Mat& sub  = finder->img;
+    auto centre = find_orange_box_center(sub, &band_track(finder_rc));
     int x_corretion = 0;
     int y_corretion = 0;
 
@@ -170,12 +247,14 @@ bool read_from_selected_item(Context& ctx,
     LOG_EVENT("[call_fn] read_from_selected_item finder (%d,%d,%d,%d)\n",
               finder_left, finder_top, finder_width, finder_height);
 
-    cv::Mat full  = so::detail::capture(ctx.hwnd);
-    cv::Mat sub   = full(cv::Rect(finder_rc.left,  finder_rc.top,
-                                  finder_rc.right - finder_rc.left,
-                                  finder_rc.bottom - finder_rc.top));
+    so::FramePtr finder = so::frame(ctx.hwnd, finder_rc);
+    if (!finder) {
+        LOG_ERROR("[call_fn] read_from_selected_item → finder outside the window\n");
+        return false;
+    }
+    const cv::Mat& sub  = finder->img;
 
-    auto centre = find_orange_box_center(sub);
+    auto centre = find_orange_box_center(sub, &band_track(finder_rc));
     if (!centre) {
         LOG_ERROR("[call_fn] read_from_selected_item → orange bar not found\n");
         return false;
@@ -200,6 +279,105 @@ bool read_from_selected_item(Context& ctx,
 }
 
 
+/*────────────────── roi_changed ──────────────────*/
+/* args:
+ * 0 var_name
+ * 1 left   2 top   3 width   4 height
+ * var_name ← "1" if the rectangle changed since set_prev, "0" otherwise;
+ * answered from the frames' tile hashes, no pixel diff unless needed
+ */
+bool roi_changed(Context& ctx,
+                 const std::vector<std::string>& args)
+{
+    if (args.size() < 5) {
+        LOG_ERROR("roi_changed: need 5 args, got %zu\n", args.size());
+        return false;
+    }
+    const int x = std::stoi(args[1]), y = std::stoi(args[2]);
+    const int w = std::stoi(args[3]), h = std::stoi(args[4]);
+    RECT rc{ x, y, x + w, y + h };
+
+    bool changed = true;                          // no set_prev → assume it moved
+    so::FramePtr now = ctx.prev ? so::frame(ctx.hwnd, rc) : nullptr;
+    if (now) {
+        std::vector<RECT> tiles = so::changed_tiles(*ctx.prev, *now, now->rc);
+        changed = !tiles.empty();
+        LOG_DEBUG("[call_fn] roi_changed (%d,%d,%d,%d) → %zu changed tiles\n",
+                  x, y, w, h, tiles.size());
+    }
+    ctx.vars[args[0]] = changed ? "1" : "0";
+    LOG_EVENT("[call_fn] roi_changed %s=%s\n", args[0].c_str(), changed ? "1" : "0");
+    return true;
+}
+
+
+/*────────────────── ocr_fields ──────────────────*/
+/* args, repeated per field:
+ * 0 var_name[@profile]
+ * 1 left   2 top   3 width   4 height
+ * all fields are read off one frame: the open ocr_session when it covers
+ * them, otherwise a session over their bounding box
+ */
+bool ocr_fields(Context& ctx,
+                const std::vector<std::string>& args)
+{
+    if (args.empty() || args.size() % 5) {
+        LOG_ERROR("ocr_fields: need groups of 5 args, got %zu\n", args.size());
+        return false;
+    }
+    std::vector<RECT> rois; std::vector<std::string> vars, profs;
+    RECT area{ INT_MAX, INT_MAX, INT_MIN, INT_MIN };
+    for (size_t i = 0; i < args.size(); i += 5) {
+        const int x = std::stoi(args[i+1]), y = std::stoi(args[i+2]);
+        const int w = std::stoi(args[i+3]), h = std::stoi(args[i+4]);
+        const auto at = args[i].find('@');
+        vars.push_back(args[i].substr(0, at));
+        profs.push_back(at == std::string::npos ? "" : args[i].substr(at + 1));
+        rois.push_back(RECT{ x, y, x + w, y + h });
+        area = RECT{ std::min<LONG>(area.left, x),      std::min<LONG>(area.top, y),
+                     std::max<LONG>(area.right, x + w), std::max<LONG>(area.bottom, y + h) };
+    }
+
+    std::shared_ptr<so::OcrSession> s = ctx.ocr;
+    if (s && s->frame()->input_seq != dw::input_seq()) s.reset();
+    for (const RECT& r : rois) if (s && !s->covers(r)) s.reset();
+    if (!s) s = so::ocr_session(ctx.hwnd, area);
+
+    std::vector<std::string> txt = s->read(rois, profs);
+    for (size_t i = 0; i < vars.size(); ++i) {
+        ctx.vars[vars[i]] = typed(txt[i], profs[i]);
+        LOG_EVENT("[call_fn] ocr_fields %s=\"%s\"\n", vars[i].c_str(), txt[i].c_str());
+    }
+    return true;
+}
+
+
+/*────────────────── find_template ──────────────────*/
+/* args:
+ * 0 var_name   1 template name
+ * [2 left   3 top   4 width   5 height]  optional search hint
+ * var_name ← "cx cy" of the match ("" when absent), like locate_phrases
+ */
+bool find_template(Context& ctx,
+                   const std::vector<std::string>& args)
+{
+    if (args.size() != 2 && args.size() != 6) {
+        LOG_ERROR("find_template: need 2 or 6 args, got %zu\n", args.size());
+        return false;
+    }
+    RECT roi{};
+    if (args.size() == 6) {
+        const int x = std::stoi(args[2]), y = std::stoi(args[3]);
+        roi = RECT{ x, y, x + std::stoi(args[4]), y + std::stoi(args[5]) };
+    }
+    auto hit = so::locate_template(ctx.hwnd, args[1], roi);
+    ctx.vars[args[0]] = hit ? std::to_string((hit->box.left + hit->box.right) / 2) + " "
+                            + std::to_string((hit->box.top + hit->box.bottom) / 2) : "";
+    LOG_EVENT("[call_fn] find_template %s=\"%s\" (%s%s)\n", args[0].c_str(),
+              ctx.vars[args[0]].text().c_str(), args[1].c_str(),
+              hit ? (" " + std::to_string(hit->score).substr(0, 5)).c_str() : " absent");
+    return true;
+}
 
 
 // returns the 4 “extreme” centers: top, bottom, left, right
@@ -315,7 +493,7 @@ Extremes find_white_square_centers(const cv::Mat& prev,
 
     // 6.5) debug: annotate centers + areas on the post image
     if (CFG_BOOL("debug_img", false)) {
-        so::detail::save_debug_image(mask,  "mask_change_map");
+        so::detail::save_debug_image(std::move(mask), "mask_change_map");
         // convert post (BGRA) → BGR for drawing
         cv::Mat dbg;
         cv::cvtColor(post, dbg, cv::COLOR_BGRA2BGR);
@@ -338,7 +516,7 @@ Extremes find_white_square_centers(const cv::Mat& prev,
         }
 
         // save out the annotated image
-        so::detail::save_debug_image(dbg, "white_centers");
+        so::detail::save_debug_image(std::move(dbg), "white_centers");
         LOG_DEBUG("[find_white] debug_centers: saved annotated image\n");
     }
 
@@ -398,7 +576,7 @@ bool change_map(dp::Context& ctx,
     LOG_EVENT("[change_map] direction='%s'\n", dir.c_str());
 
     // 1. before
-    cv::Mat prev = so::detail::capture(ctx.hwnd);
+    so::FramePtr prev = so::frame(ctx.hwnd);
     LOG_DEBUG("[change_map] captured prev frame\n");
 
     // 2. trigger map move
@@ -406,15 +584,15 @@ bool change_map(dp::Context& ctx,
     std::this_thread::sleep_for(std::chrono::milliseconds(500));
     LOG_DEBUG("[change_map] sent key 'a' and waited 150ms\n");
 
-    // 3. after
-    cv::Mat post = so::detail::capture(ctx.hwnd);
+    // 3. after (the key press already invalidated the cached frame)
+    so::FramePtr post = so::frame(ctx.hwnd);
     LOG_DEBUG("[change_map] captured post frame\n");
 
     // 4. call the diff→center routine (note the '='!)
     LOG_DEBUG("[change_map] about to find white squares...\n");
     Extremes ex;
     try {
-        ex = find_white_square_centers(prev, post);
+        ex = find_white_square_centers(prev->img, post->img);
         LOG_DEBUG(
           "[change_map] extremes: top=(%.1f,%.1f) bottom=(%.1f,%.1f) "
           "left=(%.1f,%.1f) right=(%.1f,%.1f)\n",
@@ -444,16 +622,17 @@ bool change_map(dp::Context& ctx,
     dw::click(ctx.hwnd, cx, cy + 15); // +15 is  a general overvation fix
 
     // 6. wait for map to change
-    for(int i; i<150; i++) {
-        cv::Mat win = so::detail::capture(ctx.hwnd);
-        cv::Mat region = win(cv::Rect(1100, 850, 100, 50));
+    for(int i = 0; i<150; i++) {
+        so::FramePtr win = so::frame(ctx.hwnd, RECT{1100, 850, 1200, 900});
+        const cv::Mat  region = so::pixels(win);
         /* see if it's full black */
         cv::Scalar s = cv::sum(region);
-        if(s[0] < 1000) {        // its actually zero when there is a zone change, but 1000 is a small buff in case
+        if(!region.empty() && s[0] < 1000) {        // its actually zero when there is a zone change, but 1000 is a small buff in case
             LOG_EVENT("[change_map] zone change detected with [%f]\n", s[0]);
             std::this_thread::sleep_for(std::chrono::milliseconds(CFG_INT("new_zone_delay", 1000))); // wait for new zone to update
             return true;
         }
+        so::invalidate_frame();
         std::this_thread::sleep_for(std::chrono::milliseconds(150));
     }
 
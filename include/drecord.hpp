@@ -0,0 +1,579 @@
+// drecord.hpp
+#pragma once
+/*  Session recording – one chunked, append-only file per run holding every
+ *  captured frame, every executed command and every OCR result.
+ *
+ *  Deliberately free of windows.h / OpenCV (except the mapping helper) so a
+ *  recording can be inspected and replayed offline on any box.
+ *
+ *  Layout (little-endian, every chunk starts 8-byte aligned):
+ *      FileHeader
+ *      { ChunkHeader  payload  pad }*
+ *      INDEX chunk      IndexEntry[count]
+ *      Footer           { index offset, count, "DRECEND" }
+ *  A file cut short (crash, ctrl-c) has no footer: Reader rebuilds the index
+ *  by walking the chunk headers up to the last complete chunk.
+ *
+ *  Frames are grouped in streams by capture rectangle. Each stream stores a
+ *  key frame every `key_every` frames and XOR deltas against its previous
+ *  frame in between, all deflated at level 1. Two frames of the same UI XOR
+ *  to mostly zeros, which deflate to almost nothing.
+ */
+#include <zlib.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include "dlog.hpp"
+
+#ifdef _WIN32
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace dr {
+
+/*──────────────────────────────  file format  ──────────────────────────────*/
+enum class Kind : uint32_t { Key = 1, Delta = 2, Command = 3, Ocr = 4, Index = 5 };
+
+inline const char* to_string(Kind k)
+{
+    switch (k) {
+        case Kind::Key     : return "key";
+        case Kind::Delta   : return "delta";
+        case Kind::Command : return "command";
+        case Kind::Ocr     : return "ocr";
+        case Kind::Index   : return "index";
+    }
+    return "?";
+}
+
+constexpr char     kMagic[8]    = {'D','R','E','C','0','0','0','1'};
+constexpr char     kEndMagic[8] = {'D','R','E','C','E','N','D','\0'};
+constexpr uint32_t kVersion     = 2;         // 2: OcrInfo carries its source
+
+/* what produced an OCR text – glyph_harvest only learns from Tesseract reads
+   of plain frame pixels                                                    */
+enum class OcrSource : uint32_t { Unknown = 0, Tesseract = 1, Glyph = 2, Diff = 3 };
+
+inline const char* to_string(OcrSource s)
+{
+    switch (s) {
+        case OcrSource::Unknown   : return "unknown";
+        case OcrSource::Tesseract : return "tesseract";
+        case OcrSource::Glyph     : return "glyph";
+        case OcrSource::Diff      : return "diff";
+    }
+    return "?";
+}
+
+#pragma pack(push, 1)
+struct FileHeader  { char magic[8]; uint32_t version; uint32_t reserved; };
+struct ChunkHeader { uint32_t kind; uint32_t size; uint64_t t_us; };   // size = payload bytes, t_us since open
+struct FrameInfo   {                                                    // Key / Delta payload head
+    uint32_t w, h, channels, raw_size;      // raw_size = w*h*channels (rows packed)
+    int32_t  rc[4];                         // capture rectangle in client coords
+    uint64_t seq, input_seq;
+    uint64_t ref;                           // Delta: chunk number it XORs against
+};
+struct CommandInfo { uint64_t input_seq; };                             // + UTF-8 line
+struct OcrInfo     { int32_t rc[4]; uint32_t source, reserved; };       // + UTF-8 text (v1: rc only)
+struct IndexEntry  { uint64_t offset; uint32_t kind; uint32_t size; uint64_t t_us; };
+struct Footer      { uint64_t index_offset; uint64_t count; char magic[8]; };
+#pragma pack(pop)
+
+namespace detail {
+inline size_t pad8(size_t n) { return (n + 7) & ~size_t(7); }
+
+/* a ^= b over n bytes – plain loop, auto-vectorised at -O2 */
+inline void xor_into(uint8_t* a, const uint8_t* b, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) a[i] ^= b[i];
+}
+} // namespace detail
+
+/*────────────────────────────────  writer  ─────────────────────────────────*/
+/* Callers only queue: a frame's rows are packed into a pooled buffer (the
+   pixels are usually a view into reusable capture memory), commands and OCR
+   results are copied. A writer thread XORs, deflates and appends chunks in
+   queue order, so chunk order is call order. At most `max_frames` frames
+   wait at a time; further ones are dropped (and counted), commands and OCR
+   results never are.                                                     */
+class Writer {
+public:
+    ~Writer() { close(); }
+
+    bool open(const std::string& path, int key_every = 120, int max_frames = 4)
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (f_) return true;
+        f_ = std::fopen(path.c_str(), "wb");
+        if (!f_) { LOG_ERROR("[record] cannot open %s\n", path.c_str()); return false; }
+
+        FileHeader h{};
+        std::memcpy(h.magic, kMagic, sizeof h.magic);
+        h.version = kVersion;
+        std::fwrite(&h, sizeof h, 1, f_);
+        off_        = sizeof h;
+        key_every_  = key_every > 0 ? key_every : 1;
+        max_frames_ = max_frames > 0 ? max_frames : 1;
+        t0_         = std::chrono::steady_clock::now();
+        path_       = path;
+        stop_       = false;
+        th_         = std::thread([this] { run(); });
+        open_       = true;
+        LOG_INFO("[record] recording session to %s\n", path.c_str());
+        return true;
+    }
+
+    /* drains the queue, then writes the index and footer; a recording is
+       readable without them                                               */
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            if (!f_ || stop_) return;
+            open_ = false;
+            stop_ = true;
+        }
+        cv_.notify_one();
+        if (th_.joinable()) th_.join();              // the file is ours again
+
+        const uint64_t at = off_;
+        put(Kind::Index, index_.data(), index_.size() * sizeof(IndexEntry),
+            nullptr, 0, now_us(), /*indexed=*/false);
+        Footer ft{ at, index_.size(), {} };
+        std::memcpy(ft.magic, kEndMagic, sizeof ft.magic);
+        std::fwrite(&ft, sizeof ft, 1, f_);
+        std::fclose(f_);
+        f_ = nullptr;
+        LOG_INFO("[record] %s closed: %zu chunks, %llu frames (%llu dropped), %.1f MB raw -> %.1f MB on disk\n",
+                 path_.c_str(), index_.size(), (unsigned long long)frames_, (unsigned long long)dropped_,
+                 raw_bytes_ / 1048576.0, (off_ + sizeof ft) / 1048576.0);
+        index_.clear();
+        streams_.clear();
+        spare_.clear();
+    }
+
+    bool is_open() const { return open_.load(std::memory_order_relaxed); }
+
+    /* one captured frame; rows may be padded (`stride` bytes apart) */
+    void frame(const uint8_t* bits, int w, int h, size_t stride, int channels,
+               const int32_t rc[4], uint64_t seq, uint64_t input_seq)
+    {
+        if (!is_open() || !bits || w <= 0 || h <= 0) return;
+        const size_t row = size_t(w) * channels;
+        const size_t raw = row * h;
+
+        Job* j;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            if (stop_) return;
+            if (queued_frames_ >= max_frames_) { ++dropped_; return; }
+            ++queued_frames_;
+            j = &queue_.emplace_back();              // deque: stays put while we fill it
+            j->kind = Kind::Key;
+            j->t_us = now_us();
+            if (!spare_.empty()) { j->body.swap(spare_.back()); spare_.pop_back(); }
+        }
+
+        FrameInfo& fi = j->fi;
+        fi.w = w; fi.h = h; fi.channels = channels; fi.raw_size = uint32_t(raw);
+        std::memcpy(fi.rc, rc, sizeof fi.rc);
+        fi.seq = seq; fi.input_seq = input_seq;
+        j->body.resize(raw);                         // pack rows, outside the lock
+        for (int y = 0; y < h; ++y)
+            std::memcpy(j->body.data() + y * row, bits + y * stride, row);
+
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            j->ready = true;
+        }
+        cv_.notify_one();
+    }
+
+    /* one executed proc line */
+    void command(std::string_view line, uint64_t input_seq)
+    {
+        if (!is_open()) return;
+        CommandInfo ci{ input_seq };
+        push(Kind::Command, &ci, sizeof ci, line);
+    }
+
+    /* one OCR result and where it was read */
+    void ocr(const int32_t rc[4], std::string_view text, OcrSource src = OcrSource::Unknown)
+    {
+        if (!is_open()) return;
+        OcrInfo oi{};
+        std::memcpy(oi.rc, rc, sizeof oi.rc);
+        oi.source = uint32_t(src);
+        push(Kind::Ocr, &oi, sizeof oi, text);
+    }
+
+private:
+    struct Stream {
+        std::vector<uint8_t> prev;             // last frame, rows packed
+        uint32_t w = 0, h = 0;
+        uint64_t chunk = 0;                    // chunk number of `prev`
+        int      since_key = 0;
+    };
+
+    struct Job {
+        Kind                 kind = Kind::Command;   // Key = a frame, key or delta decided later
+        uint64_t             t_us = 0;
+        FrameInfo            fi{};
+        std::vector<uint8_t> head;                   // CommandInfo / OcrInfo
+        std::vector<uint8_t> body;                   // packed rows or UTF-8 text
+        bool                 ready = false;
+    };
+
+    uint64_t now_us() const
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now() - t0_).count();
+    }
+
+    void push(Kind k, const void* info, size_t ninfo, std::string_view text)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            if (stop_) return;
+            Job& j = queue_.emplace_back();
+            j.kind = k;
+            j.t_us = now_us();
+            j.head.assign(static_cast<const uint8_t*>(info), static_cast<const uint8_t*>(info) + ninfo);
+            j.body.assign(text.begin(), text.end());
+            j.ready = true;
+        }
+        cv_.notify_one();
+    }
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mu_);
+        while (true) {
+            cv_.wait(lock, [&] { return (!queue_.empty() && queue_.front().ready)
+                                     || (stop_ && queue_.empty()); });
+            if (queue_.empty()) break;               // stopping, all drained
+            Job j = std::move(queue_.front());
+            queue_.pop_front();
+            lock.unlock();
+
+            if (j.kind == Kind::Key) write_frame(j);
+            else put(j.kind, j.head.data(), j.head.size(), j.body.data(), j.body.size(), j.t_us);
+
+            lock.lock();
+            if (j.kind == Kind::Key) {
+                --queued_frames_;
+                if (spare_.size() < 2) spare_.push_back(std::move(j.body));
+            }
+        }
+    }
+
+    /* writer thread: XOR against the stream's previous frame, deflate */
+    void write_frame(Job& j)
+    {
+        FrameInfo& fi = j.fi;
+        const size_t raw = fi.raw_size;
+        Stream& s = streams_[{fi.rc[0], fi.rc[1], fi.rc[2], fi.rc[3]}];
+
+        const bool key = s.prev.size() != raw || s.w != fi.w || s.h != fi.h
+                      || s.since_key >= key_every_;
+        std::vector<uint8_t>& work = j.body;
+        if (!key) detail::xor_into(work.data(), s.prev.data(), raw);
+
+        uLongf zn = compressBound(uLong(raw));
+        zbuf_.resize(zn);
+        if (compress2(zbuf_.data(), &zn, work.data(), uLong(raw), 1) != Z_OK) {
+            LOG_WARN("[record] compress failed (%ux%u) – frame dropped\n", fi.w, fi.h);
+            if (!key) detail::xor_into(work.data(), s.prev.data(), raw);   // keep it reusable
+            return;
+        }
+        fi.ref = key ? 0 : s.chunk;
+
+        /* keep the un-XORed frame as the next reference */
+        if (key) s.prev.swap(work);
+        else     detail::xor_into(s.prev.data(), work.data(), raw);   // prev ^ (cur ^ prev) = cur
+
+        s.w = fi.w; s.h = fi.h;
+        s.since_key = key ? 1 : s.since_key + 1;
+        s.chunk = index_.size();
+        put(key ? Kind::Key : Kind::Delta, &fi, sizeof fi, zbuf_.data(), zn, j.t_us);
+
+        ++frames_;
+        raw_bytes_ += raw;
+    }
+
+    /* writer thread (or close() once it has joined) only */
+    void put(Kind k, const void* a, size_t na, const void* b, size_t nb,
+             uint64_t t, bool indexed = true)
+    {
+        if (!f_) return;
+        ChunkHeader ch{ uint32_t(k), uint32_t(na + nb), t };
+        if (indexed) index_.push_back({ off_, ch.kind, ch.size, t });
+
+        static const uint8_t zeros[8] = {};
+        const size_t body = na + nb, pad = detail::pad8(body) - body;
+        std::fwrite(&ch, sizeof ch, 1, f_);
+        if (na) std::fwrite(a, 1, na, f_);
+        if (nb) std::fwrite(b, 1, nb, f_);
+        if (pad) std::fwrite(zeros, 1, pad, f_);
+        off_ += sizeof ch + body + pad;
+    }
+
+    /* writer thread state */
+    std::FILE*                                    f_ = nullptr;
+    std::string                                   path_;
+    uint64_t                                      off_ = 0;
+    int                                           key_every_ = 120;
+    std::chrono::steady_clock::time_point         t0_;
+    std::vector<IndexEntry>                       index_;
+    std::map<std::array<int32_t, 4>, Stream>      streams_;
+    std::vector<uint8_t>                          zbuf_;
+    uint64_t                                      frames_ = 0, raw_bytes_ = 0;
+
+    /* queue, under mu_ */
+    std::atomic<bool>                             open_{false};    // cheap no-op check
+    std::deque<Job>                               queue_;
+    std::vector<std::vector<uint8_t>>             spare_;          // frame buffers for reuse
+    int                                           max_frames_ = 4, queued_frames_ = 0;
+    uint64_t                                      dropped_ = 0;
+    bool                                          stop_ = false;
+    std::mutex                                    mu_;
+    std::condition_variable                       cv_;
+    std::thread                                   th_;
+};
+
+/* process-wide recorder; idle (every call a no-op) until open() */
+inline Writer& session()
+{
+    static Writer w; return w;
+}
+
+/*──────────────────────────────  mapped file  ──────────────────────────────*/
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path)
+    {
+#ifdef _WIN32
+        file_ = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) return;
+        LARGE_INTEGER sz{};
+        if (!::GetFileSizeEx(file_, &sz) || !sz.QuadPart) return;
+        map_ = ::CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!map_) return;
+        data_ = static_cast<const uint8_t*>(::MapViewOfFile(map_, FILE_MAP_READ, 0, 0, 0));
+        size_ = data_ ? size_t(sz.QuadPart) : 0;
+#else
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) return;
+        struct stat st{};
+        if (::fstat(fd_, &st) != 0 || !st.st_size) return;
+        void* p = ::mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (p == MAP_FAILED) return;
+        data_ = static_cast<const uint8_t*>(p);
+        size_ = size_t(st.st_size);
+#endif
+    }
+    ~MappedFile()
+    {
+#ifdef _WIN32
+        if (data_) ::UnmapViewOfFile(data_);
+        if (map_)  ::CloseHandle(map_);
+        if (file_ != INVALID_HANDLE_VALUE) ::CloseHandle(file_);
+#else
+        if (data_) ::munmap(const_cast<uint8_t*>(data_), size_);
+        if (fd_ >= 0) ::close(fd_);
+#endif
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* data() const { return data_; }
+    size_t         size() const { return size_; }
+    explicit operator bool() const { return data_ != nullptr; }
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t         size_ = 0;
+#ifdef _WIN32
+    HANDLE file_ = INVALID_HANDLE_VALUE, map_ = nullptr;
+#else
+    int    fd_ = -1;
+#endif
+};
+
+/*────────────────────────────────  reader  ─────────────────────────────────*/
+struct Image {
+    FrameInfo            info{};
+    std::vector<uint8_t> px;                 // rows packed, info.channels per pixel
+};
+
+struct Chunk {
+    Kind           kind;
+    uint64_t       t_us;
+    const uint8_t* data;                     // payload
+    uint32_t       size;
+};
+
+/* random access over a mapped (or loaded) recording – never copies the file */
+class Reader {
+public:
+    Reader(const uint8_t* data, size_t size) : data_(data), size_(size)
+    {
+        if (size_ < sizeof(FileHeader)
+            || std::memcmp(data_, kMagic, sizeof kMagic) != 0) {
+            LOG_ERROR("[record] not a session recording\n");
+            return;
+        }
+        version_ = reinterpret_cast<const FileHeader*>(data_)->version;
+        ok_ = load_index() || scan_index();
+    }
+
+    bool                           ok()    const { return ok_; }
+    bool                           complete() const { return complete_; }
+    const std::vector<IndexEntry>& index() const { return index_; }
+    size_t                         count() const { return index_.size(); }
+
+    Chunk chunk(size_t i) const
+    {
+        const IndexEntry& e = index_.at(i);
+        return { Kind(e.kind), e.t_us, data_ + e.offset + sizeof(ChunkHeader), e.size };
+    }
+
+    /* command line / OCR text of chunk i (empty for frames) */
+    std::string_view text(size_t i) const
+    {
+        Chunk c = chunk(i);
+        size_t head = c.kind == Kind::Command ? sizeof(CommandInfo)
+                    : c.kind == Kind::Ocr     ? ocr_head() : c.size;
+        return { reinterpret_cast<const char*>(c.data) + head, c.size - head };
+    }
+
+    template <class T> T info(size_t i) const
+    {
+        T t{}; std::memcpy(&t, chunk(i).data, sizeof t); return t;
+    }
+
+    /* OcrInfo of chunk i – version 1 files only stored the rectangle */
+    OcrInfo ocr(size_t i) const
+    {
+        OcrInfo oi{}; std::memcpy(&oi, chunk(i).data, ocr_head()); return oi;
+    }
+
+    /* full pixels of frame chunk i, replaying its delta chain.
+       Sequential playback reuses the last decoded frame of the stream. */
+    bool frame(size_t i, Image& out) const
+    {
+        std::vector<size_t> chain;
+        size_t j = i;
+        for (;;) {
+            Kind k = chunk(j).kind;
+            if (k != Kind::Key && k != Kind::Delta) return false;
+            if (cache_id_ == j && cache_ok_) break;
+            chain.push_back(j);
+            if (k == Kind::Key) break;
+            uint64_t ref = info<FrameInfo>(j).ref;
+            if (ref >= j) return false;                  // corrupt back-reference
+            j = size_t(ref);
+        }
+
+        Image img;
+        if (chain.empty() || chunk(chain.back()).kind != Kind::Key) img = cache_;   // start from cache
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+            Chunk     c  = chunk(*it);
+            FrameInfo fi = info<FrameInfo>(*it);
+            scratch_.resize(fi.raw_size);
+            uLongf n = fi.raw_size;
+            if (uncompress(scratch_.data(), &n, c.data + sizeof fi, c.size - sizeof fi) != Z_OK
+                || n != fi.raw_size) {
+                LOG_ERROR("[record] chunk %zu: corrupt frame data\n", *it);
+                cache_ok_ = false;
+                return false;
+            }
+            if (c.kind == Kind::Key) img.px.swap(scratch_);
+            else if (img.px.size() == n) detail::xor_into(img.px.data(), scratch_.data(), n);
+            else return false;
+            img.info = fi;
+        }
+        cache_ = img; cache_id_ = i; cache_ok_ = true;
+        out = std::move(img);
+        return true;
+    }
+
+private:
+    size_t ocr_head() const { return version_ >= 2 ? sizeof(OcrInfo) : sizeof(OcrInfo::rc); }
+
+    bool load_index()
+    {
+        if (size_ < sizeof(FileHeader) + sizeof(Footer)) return false;
+        Footer ft; std::memcpy(&ft, data_ + size_ - sizeof ft, sizeof ft);
+        if (std::memcmp(ft.magic, kEndMagic, sizeof kEndMagic) != 0) return false;
+        const uint64_t at = ft.index_offset + sizeof(ChunkHeader);
+        if (at > size_ || ft.count > (size_ - at) / sizeof(IndexEntry)) return false;
+        index_.resize(size_t(ft.count));
+        std::memcpy(index_.data(), data_ + at, index_.size() * sizeof(IndexEntry));
+        for (const IndexEntry& e : index_)
+            if (!fits(e.kind, e.offset, e.size)) {
+                LOG_WARN("[record] index entry out of bounds – ignoring the index\n");
+                index_.clear();
+                return false;
+            }
+        complete_ = true;
+        return true;
+    }
+
+    /* chunk lies inside the file and is long enough for its fixed head */
+    bool fits(uint32_t kind, uint64_t off, uint32_t size) const
+    {
+        if (kind < uint32_t(Kind::Key) || kind > uint32_t(Kind::Index)) return false;
+        if (off > size_ || sizeof(ChunkHeader) + uint64_t(size) > size_ - off) return false;
+        const size_t head = kind == uint32_t(Kind::Command) ? sizeof(CommandInfo)
+                          : kind == uint32_t(Kind::Ocr)     ? ocr_head()
+                          : kind == uint32_t(Kind::Index)   ? 0 : sizeof(FrameInfo);
+        return size >= head;
+    }
+
+    /* no footer: walk chunk headers, keep everything that is fully on disk */
+    bool scan_index()
+    {
+        LOG_WARN("[record] no index (recording cut short?) – scanning chunks\n");
+        size_t off = sizeof(FileHeader);
+        while (off + sizeof(ChunkHeader) <= size_) {
+            ChunkHeader ch; std::memcpy(&ch, data_ + off, sizeof ch);
+            size_t next = off + sizeof ch + detail::pad8(ch.size);
+            if (!fits(ch.kind, off, ch.size)) break;
+            if (Kind(ch.kind) != Kind::Index) index_.push_back({ off, ch.kind, ch.size, ch.t_us });
+            off = next;
+        }
+        return true;
+    }
+
+    const uint8_t*          data_;
+    size_t                  size_;
+    uint32_t                version_ = 0;
+    bool                    ok_ = false, complete_ = false;
+    std::vector<IndexEntry> index_;
+
+    mutable Image                cache_;
+    mutable size_t               cache_id_ = size_t(-1);
+    mutable bool                 cache_ok_ = false;
+    mutable std::vector<uint8_t> scratch_;
+};
+
+} // namespace dr
@@ -12,8 +12,32 @@
 #include <string>
 #include <vector>
 #include <mutex>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <deque>
+#include <list>
+#include <unordered_map>
+#include <optional>
+#include <fstream>
+#include <cstring>
+#include <sstream>
+#include <map>
+#include <set>
+#include <condition_variable>
+#include <exception>
+#include <chrono>
 #include <algorithm>
+#include <array>
+#include <cmath>
+#if defined(__SSE2__)
+  #include <emmintrin.h>       // SSE2 tile hash / binarise mask
+#endif
 #include "dlog.hpp"   // LOG_*
+#include "drecord.hpp"   // dr::session()
+#include "dglyph.hpp"
+#include "dfuzzy.hpp"    // phrase matcher
+#include "dtessdata.hpp"  // traineddata from memory
 #include "dutils.hpp"
 #include "dwin_api.hpp" // dw::*
 
@@ -25,23 +49,162 @@ namespace so {          /*  'so' = screen-ocr  */
 /*──────────────────────────────  internal helpers  ─────────────────────────*/
 namespace detail {
 
-inline void save_debug_image(const cv::Mat& img, const std::string& tag)
+/*  Debug images go through a background writer: the hot path only stamps a
+ *  file name and queues a copy of the Mat (no encoding, no I/O). The queue is
+ *  bounded (debug_img_queue); when it is full debug_img_drop decides whether
+ *  the oldest or the newest image is lost, or whether the caller waits.
+ *  Encoder: debug_img_format = png (debug_img_png_level, 1 = fast) | jpg
+ *  (debug_img_jpg_quality) | bmp (uncompressed).                          */
+class DebugWriter {
+public:
+    static DebugWriter& get()
+    {
+        static DebugWriter w; return w;
+    }
+
+    void push(cv::Mat img, std::string path)
+    {
+        std::unique_lock<std::mutex> lock(mu_);
+        if (!th_.joinable()) th_ = std::thread([this]{ loop(); });
+
+        if (q_.size() >= capacity_) {
+            if (policy_ == Drop::Block) {
+                cv_space_.wait(lock, [this]{ return q_.size() < capacity_ || stop_; });
+            } else if (policy_ == Drop::Oldest) {
+                q_.pop_front(); ++dropped_;
+            } else {
+                ++dropped_;
+                return;
+            }
+        }
+        q_.push_back({ std::move(img), std::move(path) });
+        cv_item_.notify_one();
+    }
+
+    /* block until everything queued so far is on disk */
+    void flush()
+    {
+        std::unique_lock<std::mutex> lock(mu_);
+        cv_space_.wait(lock, [this]{ return q_.empty() && !busy_; });
+    }
+
+    const char* ext() const { return ext_.c_str(); }
+    size_t written() const { return written_.load(); }
+    size_t dropped() const { std::lock_guard<std::mutex> lock(mu_); return dropped_; }
+
+    ~DebugWriter()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            stop_ = true;
+        }
+        cv_item_.notify_all();
+        cv_space_.notify_all();
+        if (th_.joinable()) {
+            th_.join();
+            LOG_INFO("[debug_img] written=%zu  dropped=%zu\n", written_.load(), dropped_);
+        }
+    }
+
+private:
+    enum class Drop { Oldest, Newest, Block };
+    struct Item { cv::Mat img; std::string path; };
+
+    DebugWriter()
+    {
+        capacity_ = std::max(1, CFG_INT("debug_img_queue", 32));
+
+        std::string drop = CFG_STR("debug_img_drop", "oldest");
+        policy_ = drop == "newest" ? Drop::Newest
+                : drop == "block"  ? Drop::Block : Drop::Oldest;
+
+        std::string fmt = CFG_STR("debug_img_format", "png");
+        if (fmt == "jpg" || fmt == "jpeg") {
+            ext_    = "jpg";
+            params_ = { cv::IMWRITE_JPEG_QUALITY, CFG_INT("debug_img_jpg_quality", 90) };
+        } else if (fmt == "bmp" || fmt == "raw") {
+            ext_    = "bmp";
+        } else {
+            ext_    = "png";
+            params_ = { cv::IMWRITE_PNG_COMPRESSION, CFG_INT("debug_img_png_level", 1) };
+        }
+    }
+    DebugWriter(const DebugWriter&) = delete;
+    DebugWriter& operator=(const DebugWriter&) = delete;
+
+    void loop()
+    {
+        for (;;) {
+            Item it;
+            {
+                std::unique_lock<std::mutex> lock(mu_);
+                cv_item_.wait(lock, [this]{ return !q_.empty() || stop_; });
+                if (q_.empty()) return;                  // stop_ and drained
+                it = std::move(q_.front());
+                q_.pop_front();
+                busy_ = true;
+            }
+            cv_space_.notify_all();
+
+            if (!cv::imwrite(it.path, it.img, params_))
+                LOG_WARN("[debug_img] could not write %s\n", it.path.c_str());
+            else
+                ++written_;
+
+            {
+                std::lock_guard<std::mutex> lock(mu_);
+                busy_ = false;
+            }
+            cv_space_.notify_all();
+        }
+    }
+
+    mutable std::mutex      mu_;
+    std::condition_variable cv_item_, cv_space_;
+    std::deque<Item>        q_;
+    std::thread             th_;
+    bool                    stop_ = false, busy_ = false;
+    size_t                  capacity_ = 32, dropped_ = 0;
+    std::atomic<size_t>     written_{0};
+    Drop                    policy_ = Drop::Oldest;
+    std::string             ext_;
+    std::vector<int>        params_;
+};
+
+inline std::string debug_image_path(const std::string& tag)
 {
     SYSTEMTIME st;
     GetSystemTime(&st);
 
     char buf[256];
-    snprintf(buf, sizeof(buf), "%s/debug_%s_%04d%02d%02d_%02d%02d%02d_%03d.png",
+    snprintf(buf, sizeof(buf), "%s/debug_%s_%04d%02d%02d_%02d%02d%02d_%03d.%s",
                 CFG_STR("temp_dir", "./temp").c_str(), 
                 tag.c_str(),
                 st.wYear, st.wMonth, st.wDay,
                 st.wHour, st.wMinute, st.wSecond,
-                st.wMilliseconds);  // <- added milliseconds
+                st.wMilliseconds,  // <- added milliseconds
+                DebugWriter::get().ext());
+    return buf;
+}
+
+/* a copy: capture-thread slots and DIB sections are rewritten in place, so
+   a shared header could be encoded torn or from a later frame            */
+inline void save_debug_image(const cv::Mat& img, const std::string& tag)
+{
+    DebugWriter::get().push(img.clone(), debug_image_path(tag));
+}
 
-    cv::imwrite(buf, img);
+/* handed over: a Mat the caller allocated and will not write again (a
+   binarised crop, a diff) is queued as is. Views – ROIs or headers over
+   foreign memory – are still copied.                                     */
+inline void save_debug_image(cv::Mat&& img, const std::string& tag)
+{
+    if (!img.u || img.isSubmatrix()) { save_debug_image(img, tag); return; }
+    DebugWriter::get().push(std::move(img), debug_image_path(tag));
 }
 
-/* capture HWND → cv::Mat (BGRA, 8-bit) */
+/* capture HWND → cv::Mat (BGRA, 8-bit) – one-shot GDI path that owns its
+   pixels; used when capture_context=false and as the benchmark baseline  */
 inline cv::Mat capture(HWND hwnd, bool overwrite_dbug=false)
 {
     RECT rc {};  ::GetClientRect(hwnd, &rc);
@@ -70,9 +233,145 @@ if(CFG_BOOL("debug_img",false) && !overwrite_dbug) {
     return img;
 }
 
+/* RECT (client coords) → cv::Rect */
+inline cv::Rect to_rect(const RECT& r)
+{
+    return cv::Rect(r.left, r.top, r.right - r.left, r.bottom - r.top);
+}
+
+/* two-colour split of a BGR(A) image on a 32x32x32 colour histogram:
+ * weighted Lloyd iterations over the occupied bins (per-bin colour means,
+ * not bin centres), then every pixel goes to the nearer centre. Returns
+ * false when the centres are closer than `min_dist` (nothing to split).
+ *
+ * "nearer centre" is a plane: 2·p·(c1-c0) > |c1|²-|c0|², so the mask pass
+ * is one fixed-point dot product per pixel, 16 pixels per SSE2 iteration.
+ * c1 is the brighter centre → 255, c0 → 0.                               */
+inline bool two_means_mask(const uint8_t* bits, int w, int h, size_t stride, int ch,
+                           uint8_t* out, size_t out_stride, double min_dist)
+{
+    constexpr int B = 32, SH = 3;                 // 5 bits per channel
+    std::vector<uint32_t> cnt(B * B * B, 0);
+    std::vector<std::array<uint32_t, 3>> sum(B * B * B, { 0, 0, 0 });
+    for (int y = 0; y < h; ++y) {
+        const uint8_t* p = bits + size_t(y) * stride;
+        for (int x = 0; x < w; ++x, p += ch) {
+            const int k = (p[0] >> SH) << 10 | (p[1] >> SH) << 5 | (p[2] >> SH);
+            ++cnt[k]; sum[k][0] += p[0]; sum[k][1] += p[1]; sum[k][2] += p[2];
+        }
+    }
+
+    struct Bin { float c[3]; float n; };
+    std::vector<Bin> bins;
+    for (int k = 0; k < B * B * B; ++k)
+        if (cnt[k]) {
+            const float n = float(cnt[k]);
+            bins.push_back({ { sum[k][0] / n, sum[k][1] / n, sum[k][2] / n }, n });
+        }
+    if (bins.empty()) return false;
+
+    auto d2 = [](const float* a, const float* b) {
+        const float x = a[0] - b[0], y = a[1] - b[1], z = a[2] - b[2];
+        return x * x + y * y + z * z;
+    };
+
+    /* seeds: the most populated bin, then the bin farthest from it (weighted) */
+    float c[2][3];
+    const Bin* s0 = &*std::max_element(bins.begin(), bins.end(),
+                                       [](const Bin& a, const Bin& b) { return a.n < b.n; });
+    const Bin* s1 = s0;
+    float best = -1.f;
+    for (const Bin& b : bins)
+        if (float v = d2(b.c, s0->c) * b.n; v > best) { best = v; s1 = &b; }
+    std::copy(s0->c, s0->c + 3, c[0]);
+    std::copy(s1->c, s1->c + 3, c[1]);
+
+    for (int it = 0; it < 10; ++it) {             // same stop rule as before: 10 iters / eps 1.0
+        double acc[2][4] = {};
+        for (const Bin& b : bins) {
+            const int l = d2(b.c, c[1]) < d2(b.c, c[0]);
+            for (int j = 0; j < 3; ++j) acc[l][j] += double(b.c[j]) * b.n;
+            acc[l][3] += b.n;
+        }
+        float moved = 0.f;
+        for (int l = 0; l < 2; ++l) {
+            if (acc[l][3] == 0) continue;
+            float nc[3] = { float(acc[l][0] / acc[l][3]), float(acc[l][1] / acc[l][3]),
+                            float(acc[l][2] / acc[l][3]) };
+            moved = std::max(moved, d2(nc, c[l]));
+            std::copy(nc, nc + 3, c[l]);
+        }
+        if (moved <= 1.f) break;
+    }
 
-/* binarise using the same K-means trick you already had              */
+    if (std::sqrt(d2(c[0], c[1])) < min_dist) return false;
+    if (c[0][0] + c[0][1] + c[0][2] > c[1][0] + c[1][1] + c[1][2])
+        for (int j = 0; j < 3; ++j) std::swap(c[0][j], c[1][j]);
+
+    /* p·wv > thr, weights in 1/32 units (|w| ≤ 255·32 fits int16) */
+    int16_t wv[3]; int32_t thr;
+    {
+        double t = 0;
+        for (int j = 0; j < 3; ++j) {
+            wv[j] = int16_t(std::lround((c[1][j] - c[0][j]) * 32.0));
+            t += (double(c[1][j]) * c[1][j] - double(c[0][j]) * c[0][j]) * 16.0;
+        }
+        thr = int32_t(std::floor(t));
+    }
+
+    for (int y = 0; y < h; ++y) {
+        const uint8_t* p = bits + size_t(y) * stride;
+        uint8_t*       o = out  + size_t(y) * out_stride;
+        int x = 0;
+#if defined(__SSE2__)
+        if (ch == 4) {
+            const __m128i W  = _mm_setr_epi16(wv[0], wv[1], wv[2], 0, wv[0], wv[1], wv[2], 0);
+            const __m128i T  = _mm_set1_epi32(thr);
+            const __m128i Z  = _mm_setzero_si128();
+            /* 4 BGRA pixels → 4 dot products (int32) */
+            auto dot4 = [&](const uint8_t* q) {
+                __m128i v  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(q));
+                __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(v, Z), W);   // b·wb+g·wg, r·wr  (px 0,1)
+                __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(v, Z), W);   //                  (px 2,3)
+                lo = _mm_add_epi32(lo, _mm_srli_epi64(lo, 32));           // sums in lanes 0, 2
+                hi = _mm_add_epi32(hi, _mm_srli_epi64(hi, 32));
+                __m128i s = _mm_unpacklo_epi64(_mm_shuffle_epi32(lo, _MM_SHUFFLE(3, 1, 2, 0)),
+                                               _mm_shuffle_epi32(hi, _MM_SHUFFLE(3, 1, 2, 0)));
+                return _mm_cmpgt_epi32(s, T);                              // -1 = brighter centre
+            };
+            for (; x + 16 <= w; x += 16) {
+                __m128i a = _mm_packs_epi32(dot4(p + x * 4),      dot4(p + x * 4 + 16));
+                __m128i b = _mm_packs_epi32(dot4(p + x * 4 + 32), dot4(p + x * 4 + 48));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(o + x), _mm_packs_epi16(a, b));
+            }
+        }
+#endif
+        for (; x < w; ++x) {                                   // tail, or every pixel without SSE2
+            const uint8_t* q = p + size_t(x) * ch;
+            o[x] = int32_t(q[0]) * wv[0] + int32_t(q[1]) * wv[1] + int32_t(q[2]) * wv[2] > thr ? 255 : 0;
+        }
+    }
+    return true;
+}
+
+/* binarise: two colour clusters → black / white (see two_means_mask);
+   the BGR image comes back unchanged when the two colours are too close */
 inline cv::Mat binarise(const cv::Mat& src)
+{
+    const double thr = CFG_DBL("binary_image_threshold", 8.0);
+    cv::Mat bw(src.rows, src.cols, CV_8UC1);
+    if (two_means_mask(src.data, src.cols, src.rows, src.step, src.channels(),
+                       bw.data, bw.step, thr))
+        return bw;
+
+    cv::Mat img;                                  // clusters too close → skip
+    if (src.channels() == 4) cv::cvtColor(src, img, cv::COLOR_BGRA2BGR);
+    else                     img = src;
+    return img;
+}
+
+/* previous per-pixel float k-means – kept as the reference for bench_binarise */
+inline cv::Mat binarise_kmeans(const cv::Mat& src)
 {
     cv::Mat img; cv::cvtColor(src, img, cv::COLOR_BGRA2BGR);
 
@@ -113,20 +412,858 @@ inline cv::Mat binarise_wrap(const cv::Mat& src) {
     }
 }
 
-/* convert cv::Mat (BGR/BW) to tesseract image  */
-inline void set_image(tesseract::TessBaseAPI& api, const cv::Mat& m)
-{
-    cv::Mat img;
-    int chans = m.channels();
-    if (chans == 4) cv::cvtColor(m, img, cv::COLOR_BGRA2RGB);
-    else if (chans == 3) cv::cvtColor(m, img, cv::COLOR_BGR2RGB);
-    else img = m.clone();                       // already mono
+/* convert cv::Mat (BGR/BW) to tesseract image  */
+inline void set_image(tesseract::TessBaseAPI& api, const cv::Mat& m)
+{
+    cv::Mat img;
+    int chans = m.channels();
+    if (chans == 4) cv::cvtColor(m, img, cv::COLOR_BGRA2RGB);
+    else if (chans == 3) cv::cvtColor(m, img, cv::COLOR_BGR2RGB);
+    else img = m.clone();                       // already mono
+
+    api.SetImage(img.data, img.cols, img.rows,
+                 img.channels(), (int)img.step);
+}
+
+} // namespace detail
+
+/*──────────────────────────────  frame cache  ──────────────────────────────
+ *  One interpreter step never captures the window twice: the first reader
+ *  grabs the client area, every later reader of the same generation shares
+ *  it. The generation moves on at each step boundary (unless a `snapshot`
+ *  pinned the frame) and on any input posted through dw::* helpers.       */
+struct TileGrid;                  // see "change map" below
+
+struct Frame {
+    cv::Mat  img;                 // BGRA, 8-bit – never modified in place
+    RECT     rc{};                // client-area rectangle covered by img
+    HWND     hwnd{};
+    uint64_t gen{};               // cache generation it was captured in
+    uint64_t input_seq{};         // dw::input_seq() when it was captured
+    uint64_t seq{};               // capture-thread frame number (0 = direct grab)
+    std::chrono::steady_clock::time_point ts{};  // when the grab started
+    std::shared_ptr<const void> lease;   // DIB-section slot img points into
+    mutable std::shared_ptr<const TileGrid> tiles;   // lazy, see so::tiles()
+};
+using FramePtr = std::shared_ptr<const Frame>;
+/* NOTE: with capture_context=true `img` is a view into a reusable DIB
+   section – keep the FramePtr (not just the cv::Mat) alive while reading. */
+
+namespace detail {
+/* append a frame to the session recording (no-op unless record_session) */
+inline void record(const Frame& f)
+{
+    if (!dr::session().is_open() || f.img.empty()) return;
+    const int32_t rc[4] = { int32_t(f.rc.left), int32_t(f.rc.top),
+                            int32_t(f.rc.right), int32_t(f.rc.bottom) };
+    dr::session().frame(f.img.data, f.img.cols, f.img.rows, f.img.step,
+                        f.img.channels(), rc, f.seq, f.input_seq);
+}
+
+inline std::string record_ocr(const RECT& r, std::string text,
+                              dr::OcrSource src = dr::OcrSource::Tesseract)
+{
+    if (dr::session().is_open()) {
+        const int32_t rc[4] = { int32_t(r.left), int32_t(r.top), int32_t(r.right), int32_t(r.bottom) };
+        dr::session().ocr(rc, text, src);
+    }
+    return text;
+}
+
+/* fresh full-client frame: zero-copy view into the HWND's capture context,
+   or the one-shot GDI copy when capture_context=false. No recording, no
+   debug image – the capture thread grabs through here and its consumers
+   log the frames they actually take (see seen()).                         */
+inline FramePtr grab_raw(HWND hwnd, uint64_t gen = 0)
+{
+    auto f = std::make_shared<Frame>();
+    f->input_seq = dw::input_seq();          // read before grabbing pixels
+    f->ts        = std::chrono::steady_clock::now();
+    f->hwnd      = hwnd;
+    f->gen       = gen;
+
+    if (CFG_BOOL("capture_context", true)) {
+        dw::Capture cap = dw::capture_context(hwnd).grab();
+        if (cap) {
+            f->img   = cv::Mat(cap.h, cap.w, CV_8UC4, const_cast<uint8_t*>(cap.bits), cap.stride);
+            f->lease = std::move(cap.lease);
+        }
+    }
+    if (f->img.empty()) f->img = capture(hwnd, /*overwrite_dbug=*/true);
+    f->rc = RECT{0, 0, f->img.cols, f->img.rows};
+    return f;
+}
+
+/* a full frame the interpreter is about to use: debug image + recording */
+inline void seen(const Frame& f)
+{
+    if (CFG_BOOL("debug_img", false))
+        save_debug_image(f.img, "capture");
+    record(f);
+}
+
+inline FramePtr grab(HWND hwnd, uint64_t gen = 0)
+{
+    FramePtr f = grab_raw(hwnd, gen);
+    seen(*f);
+    return f;
+}
+
+inline bool is_black(const cv::Mat& img)
+{
+    cv::Scalar s = cv::sum(img);
+    return s[0] + s[1] + s[2] == 0;
+}
+
+/* ROIs a full PrintWindow frame showed black as well: for these a black
+   blit is the real picture, not a surface BitBlt cannot read            */
+class BlackRois {
+public:
+    static BlackRois& get() { static BlackRois b; return b; }
+
+    bool known(HWND hwnd, const RECT& r) const
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        return set_.count(key(hwnd, r)) != 0;
+    }
+    void confirm(HWND hwnd, const RECT& r)
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        set_.insert(key(hwnd, r));
+    }
+
+private:
+    using Key = std::array<intptr_t, 5>;
+    static Key key(HWND hwnd, const RECT& r)
+    {
+        return { intptr_t(hwnd), r.left, r.top, r.right, r.bottom };
+    }
+    mutable std::mutex mu_;
+    std::set<Key>      set_;
+};
+
+/* capture only the given client rectangles → one Frame per ROI, each a view
+ * into a single strip: one DC, one BitBlt per ROI, no full-window grab.
+ * A ROI with no pixels inside the client area gets a nullptr.
+ * Returns an empty vector – the caller falls back to the full capture –
+ * when a ROI is not fully visible without desktop composition (see
+ * dw::CaptureContext::grab), or when a ROI comes back all black: BitBlt
+ * cannot read GPU-rendered areas, so black may be unreadable rather than
+ * dark. Those ROIs are listed in `black`; once a full frame shows one of
+ * them black too (BlackRois) its black blit is taken as is.              */
+inline std::vector<FramePtr> capture_rois(HWND hwnd, const std::vector<RECT>& rois,
+                                          uint64_t gen = 0,
+                                          std::vector<size_t>* black = nullptr)
+{
+    RECT rc {};  ::GetClientRect(hwnd, &rc);
+    const cv::Rect client(0, 0, rc.right, rc.bottom);
+
+    std::vector<RECT> boxes;  boxes.reserve(rois.size());
+    for (const RECT& r : rois) {
+        cv::Rect b = to_rect(r) & client;
+        if (b.size() != to_rect(r).size())
+            LOG_WARN("[capture_rois] roi (%ld,%ld,%ld,%ld) clipped to client area\n",
+                     r.left, r.top, r.right, r.bottom);
+        if (b.empty()) {
+            LOG_WARN("[capture_rois] roi (%ld,%ld,%ld,%ld) outside the client area\n",
+                     r.left, r.top, r.right, r.bottom);
+            b = cv::Rect();
+        }
+        boxes.push_back(RECT{b.x, b.y, b.x + b.width, b.y + b.height});
+    }
+
+    const uint64_t seq = dw::input_seq();
+    const auto     ts  = std::chrono::steady_clock::now();
+    dw::Capture cap = dw::capture_context(hwnd).grab(boxes);
+    if (!cap) return {};
+
+    cv::Mat strip(cap.h, cap.w, CV_8UC4, const_cast<uint8_t*>(cap.bits), cap.stride);
+    bool unread = false;
+    for (size_t i = 0, y = 0; i < boxes.size(); ++i) {
+        int w = boxes[i].right - boxes[i].left, h = boxes[i].bottom - boxes[i].top;
+        if (w <= 0 || h <= 0) continue;
+        if (is_black(strip(cv::Rect(0, int(y), w, h))) && !BlackRois::get().known(hwnd, rois[i])) {
+            if (black) black->push_back(i);
+            unread = true;
+        }
+        y += h;
+    }
+    if (unread) {
+        LOG_DEBUG("[capture_rois] black blit – falling back to full capture\n");
+        return {};
+    }
+
+    if (CFG_BOOL("debug_img", false))
+        save_debug_image(strip, "capture_roi");
+
+    std::vector<FramePtr> out; out.reserve(rois.size());
+    int y = 0;
+    for (const RECT& b : boxes) {
+        int w = b.right - b.left, h = b.bottom - b.top;
+        if (w <= 0 || h <= 0) { out.push_back(nullptr); continue; }
+        auto f = std::make_shared<Frame>();
+        f->img = strip(cv::Rect(0, y, w, h)); y += h;
+        f->rc = b;  f->hwnd = hwnd;  f->gen = gen;  f->input_seq = seq;  f->ts = ts;
+        f->lease = cap.lease;
+        record(*f);
+        out.push_back(f);
+    }
+    return out;
+}
+} // namespace detail
+
+/*──────────────────────────── capture thread ───────────────────────────────
+ *  Optional producer (capture_fps > 0) that keeps grabbing the window into a
+ *  small ring of owned frames, so waits and diffs pick up a ready frame
+ *  instead of paying for the capture on the interpreter thread.
+ *
+ *  Single producer / many consumers, no locks on either side:
+ *    - each slot carries a seqlock word (frame number << 1, low bit = being
+ *      written) and a reader count;
+ *    - the producer marks a slot busy, backs off if anyone reads it and
+ *      simply tries the next slot – it never waits for a consumer;
+ *    - a consumer bumps the reader count, then re-checks the seqlock word;
+ *      if the slot moved on it lets go and retries on the newer frame.
+ *  The FramePtr handed out holds the reader count until it is dropped.    */
+class CaptureThread {
+public:
+    static CaptureThread& get()
+    {
+        static CaptureThread t; return t;
+    }
+
+    void start(HWND hwnd, int fps)
+    {
+        if (run_.exchange(true)) return;
+        hwnd_   = hwnd;
+        period_ = std::chrono::microseconds(1000000 / std::max(1, fps));
+        /* the ring is allocated once: FramePtrs from an earlier run may still
+           point into it, and claim() never reuses a slot that is being read */
+        if (ring_.empty())
+            ring_ = std::vector<Slot>(size_t(std::clamp(CFG_INT("capture_thread_ring", 6), 3, 255)));  // index packs in 8 bits
+        latest_.store(0, std::memory_order_seq_cst);
+        LOG_INFO("[capture_thread] start  fps=%d  ring=%zu\n", fps, ring_.size());
+        th_ = std::thread([this]{ loop(); });
+    }
+
+    void stop()
+    {
+        if (!run_.exchange(false)) return;
+        if (th_.joinable()) th_.join();
+        LOG_INFO("[capture_thread] stop  frames=%llu  skipped=%llu\n",
+                 (unsigned long long)produced_, (unsigned long long)skipped_);
+    }
+
+    bool running(HWND hwnd) const { return run_.load() && hwnd_ == hwnd; }
+
+    /* newest published frame, nullptr before the first one – never blocks */
+    FramePtr latest()
+    {
+        for (;;) {
+            uint64_t p = latest_.load(std::memory_order_seq_cst);
+            if (!p) return nullptr;
+            Slot& s = ring_[p & 0xff];
+            s.readers.fetch_add(1, std::memory_order_seq_cst);
+            if (s.word.load(std::memory_order_seq_cst) == ((p >> 8) << 1)) {
+                return FramePtr(&s.frame, [&s](const Frame*) {
+                    s.readers.fetch_sub(1, std::memory_order_release);
+                });
+            }
+            s.readers.fetch_sub(1, std::memory_order_release);   // overwritten – retry
+        }
+    }
+
+    /* newest frame whose grab started after input `n` and not before `since`;
+       polls until one is published or `timeout` expires (then nullptr)     */
+    FramePtr after_input(uint64_t n,
+                         std::chrono::steady_clock::time_point since = {},
+                         std::chrono::milliseconds timeout = std::chrono::milliseconds(500))
+    {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (run_.load()) {
+            if (FramePtr f = latest(); f && f->input_seq >= n && f->ts >= since)
+                return f;
+            if (std::chrono::steady_clock::now() > deadline) break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return nullptr;
+    }
+
+    ~CaptureThread() { stop(); }
+
+private:
+    CaptureThread() = default;
+    CaptureThread(const CaptureThread&) = delete;
+    CaptureThread& operator=(const CaptureThread&) = delete;
+
+    struct Slot {
+        Frame                 frame;        // owned pixels, reused in place
+        std::atomic<uint64_t> word{0};      // seqlock: frame number << 1 | writing
+        std::atomic<int>      readers{0};
+    };
+
+    /* claim a slot nobody reads, never the one currently published */
+    Slot* claim(size_t cur)
+    {
+        for (size_t k = 1; k < ring_.size(); ++k) {
+            size_t i = (cur + k) % ring_.size();
+            Slot&  s = ring_[i];
+            uint64_t w = s.word.load(std::memory_order_seq_cst);
+            s.word.store(w | 1, std::memory_order_seq_cst);
+            if (s.readers.load(std::memory_order_seq_cst) == 0) { idx_ = i; return &s; }
+            s.word.store(w, std::memory_order_seq_cst);          // in use – next one
+        }
+        return nullptr;
+    }
+
+    void loop()
+    {
+        uint64_t& n = seq_;
+        while (run_.load()) {
+            auto t0 = std::chrono::steady_clock::now();
+
+            Slot* s = claim(latest_.load() & 0xff);
+            if (!s) {
+                ++skipped_;
+            } else {
+                FramePtr g = detail::grab_raw(hwnd_);
+                g->img.copyTo(s->frame.img);             // reuses the slot buffer
+                s->frame.rc        = g->rc;
+                s->frame.hwnd      = g->hwnd;
+                s->frame.input_seq = g->input_seq;
+                s->frame.ts        = g->ts;
+                s->frame.seq       = ++n;
+                std::atomic_store(&s->frame.tiles, std::shared_ptr<const TileGrid>());
+                s->word.store(n << 1, std::memory_order_seq_cst);
+                latest_.store((n << 8) | idx_, std::memory_order_seq_cst);
+                ++produced_;
+            }
+            std::this_thread::sleep_until(t0 + period_);
+        }
+    }
+
+    std::vector<Slot>         ring_;
+    std::atomic<uint64_t>     latest_{0};          // frame number << 8 | slot index
+    size_t                    idx_ = 0;
+    uint64_t                  seq_ = 0;            // frame number, kept across restarts
+    std::atomic<bool>         run_{false};
+    std::thread               th_;
+    HWND                      hwnd_{};
+    std::chrono::microseconds period_{100000};
+    uint64_t                  produced_ = 0, skipped_ = 0;
+};
+
+class FrameCache {
+public:
+    static FrameCache& get()
+    {
+        static FrameCache c; return c;
+    }
+
+    /* current frame – captured on first use, then shared */
+    FramePtr frame(HWND hwnd)
+    {
+        std::unique_lock<std::mutex> lock(mu_);
+        if (valid(hwnd)) {
+            ++hits_;
+            LOG_DEBUG("[frame] hit  gen=%llu  (hits=%zu misses=%zu)\n",
+                      (unsigned long long)gen_, hits_, misses_);
+            return cur_;
+        }
+        ++misses_;
+        return capture_locked(lock, hwnd);
+    }
+
+    /* current frame if one is cached, nullptr otherwise – never captures */
+    FramePtr peek(HWND hwnd)
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (!valid(hwnd)) return nullptr;
+        ++hits_;
+        return cur_;
+    }
+
+    /* capture now and keep sharing the frame across steps until input */
+    FramePtr pin(HWND hwnd)
+    {
+        std::unique_lock<std::mutex> lock(mu_);
+        ++gen_;
+        pinned_ = true;
+        LOG_DEBUG("[frame] snapshot pinned  gen=%llu\n", (unsigned long long)gen_);
+        return capture_locked(lock, hwnd);
+    }
+
+    /* forget the cached frame (input, sleep, polling loops …) */
+    void invalidate()
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        ++gen_;
+        pinned_ = false;
+        cur_.reset();
+        stale_  = std::chrono::steady_clock::now();
+    }
+
+    /* interpreter step boundary – a pinned snapshot survives it */
+    void next_step()
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (pinned_ && cur_ && cur_->input_seq == dw::input_seq()) return;
+        ++gen_;
+        pinned_ = false;
+        cur_.reset();
+    }
+
+    uint64_t generation() const
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        return gen_;
+    }
+
+private:
+    FrameCache() = default;
+    FrameCache(const FrameCache&) = delete;
+    FrameCache& operator=(const FrameCache&) = delete;
+
+    bool valid(HWND hwnd) const
+    {
+        return cur_ && cur_->hwnd == hwnd && cur_->gen == gen_
+                    && cur_->input_seq == dw::input_seq();
+    }
+
+    FramePtr capture_locked(std::unique_lock<std::mutex>& lock, HWND hwnd)
+    {
+        /* capture thread running: take its newest frame taken after the last
+           input (and after the last explicit invalidate) instead of grabbing.
+           The wait runs unlocked so peek() and other readers are not held up;
+           the result is only cached if no invalidate came in meanwhile.    */
+        CaptureThread& ct = CaptureThread::get();
+        if (ct.running(hwnd)) {
+            const uint64_t gen   = gen_;
+            const auto     stale = stale_;
+            lock.unlock();
+            FramePtr f = ct.after_input(dw::input_seq(), stale);
+            lock.lock();
+            if (f) {
+                auto c = std::make_shared<Frame>(*f);
+                c->gen = gen;
+                c->lease = f;                        // holds the slot's reader count
+                detail::seen(*c);                    // the thread itself records nothing
+                if (gen_ == gen) cur_ = c;
+                return c;
+            }
+            LOG_DEBUG("[frame] capture thread had no fresh frame – grabbing\n");
+        }
+        cur_ = detail::grab(hwnd, gen_);
+        return cur_;
+    }
+
+    mutable std::mutex mu_;
+    FramePtr cur_;
+    uint64_t gen_    = 0;
+    bool     pinned_ = false;
+    size_t   hits_   = 0, misses_ = 0;
+    std::chrono::steady_clock::time_point stale_{};   // last explicit invalidate
+};
+
+/* shared frame of the current step */
+inline FramePtr frame(HWND hwnd)            { return FrameCache::get().frame(hwnd); }
+
+namespace detail {
+/* view of `roi` inside an already captured frame, nullptr when they
+   do not overlap                                                       */
+inline FramePtr crop(const FramePtr& f, const RECT& roi)
+{
+    if (!f) return nullptr;
+    cv::Rect b = to_rect(roi) & to_rect(f->rc);
+    if (b.empty()) return nullptr;
+    auto c = std::make_shared<Frame>(*f);
+    c->img = f->img(b - cv::Point(f->rc.left, f->rc.top));
+    c->rc  = RECT{b.x, b.y, b.x + b.width, b.y + b.height};
+    return c;
+}
+} // namespace detail
+
+/* several ROIs of the current step: cropped from the shared frame when one
+   is cached, otherwise blitted in one pass without grabbing the window.
+   A ROI lying outside the client area yields nullptr – check before use. */
+inline std::vector<FramePtr> frames(HWND hwnd, const std::vector<RECT>& rois)
+{
+    std::vector<FramePtr> out; out.reserve(rois.size());
+    FramePtr full = FrameCache::get().peek(hwnd);
+
+    if (!full && CFG_BOOL("roi_capture", true)
+              && !CaptureThread::get().running(hwnd)) {  // thread frames are free
+        std::vector<size_t> black;
+        out = detail::capture_rois(hwnd, rois, FrameCache::get().generation(), &black);
+        if (out.size() == rois.size()) return out;
+        out.clear();
+
+        full = frame(hwnd);
+        for (const RECT& r : rois) out.push_back(detail::crop(full, r));
+        for (size_t i : black)                             // dark, not unreadable
+            if (out[i] && detail::is_black(out[i]->img))
+                detail::BlackRois::get().confirm(hwnd, rois[i]);
+        return out;
+    }
+
+    if (!full) full = frame(hwnd);
+    for (const RECT& r : rois) out.push_back(detail::crop(full, r));
+    return out;
+}
+/* just one ROI – see frames(); nullptr when it is off the client area */
+inline FramePtr frame(HWND hwnd, const RECT& roi)
+{
+    return frames(hwnd, {roi}).front();
+}
+/* pixels of a frame, empty Mat for a null pointer */
+inline cv::Mat  pixels(const FramePtr& f)   { return f ? f->img : cv::Mat(); }
+/* `snapshot` – pin one frame for all following reads until the next input */
+inline FramePtr snapshot(HWND hwnd)         { return FrameCache::get().pin(hwnd); }
+inline void     invalidate_frame()          { FrameCache::get().invalidate(); }
+
+/*──────────────────────────────  OCR cache  ────────────────────────────────
+ *  Content-addressed: the key is a hash of the exact pixels handed to
+ *  Tesseract plus everything that changes its answer (PSM, whitelist,
+ *  languages). Same crop → same text, for the cost of a hash. LRU bounded
+ *  by ocr_cache_size; persisted to ocr_cache_file (if set) across runs.   */
+namespace detail {
+inline uint64_t mix64(uint64_t h)
+{
+    h ^= h >> 33; h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33; h *= 0xc4ceb9fe1a85ec53ull;
+    return h ^ (h >> 33);
+}
+
+inline uint64_t hash_bytes(const void* p, size_t n, uint64_t h)
+{
+    const uint8_t* b = static_cast<const uint8_t*>(p);
+    for (; n >= 8; n -= 8, b += 8) {
+        uint64_t v; std::memcpy(&v, b, 8);
+        h = (h ^ mix64(v)) * 0x9e3779b97f4a7c15ull;
+    }
+    uint64_t tail = 0;
+    std::memcpy(&tail, b, n);
+    return mix64(h ^ mix64(tail ^ (uint64_t(n) << 56)));
+}
+
+/* rows may be padded – hash only the visible bytes, plus the geometry */
+inline uint64_t hash_mat(const cv::Mat& m, uint64_t seed = 0)
+{
+    uint64_t h = mix64(seed ^ (uint64_t(m.cols) << 32 | uint32_t(m.rows)) ^ uint64_t(m.type()) << 48);
+    const size_t row = m.cols * m.elemSize();
+    for (int y = 0; y < m.rows; ++y) h = hash_bytes(m.ptr(y), row, h);
+    return h;
+}
+} // namespace detail
+
+class OcrCache {
+public:
+    static OcrCache& get()
+    {
+        static OcrCache c; return c;
+    }
+
+    bool enabled() const { return cap_ > 0; }
+
+    std::optional<std::string> find(uint64_t key)
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto it = map_.find(key);
+        if (it == map_.end()) {
+            ++misses_;
+            return std::nullopt;
+        }
+        lru_.splice(lru_.begin(), lru_, it->second);       // most recent first
+        ++hits_;
+        LOG_DEBUG("[ocr_cache] hit \"%s\"  (hits=%zu misses=%zu)\n",
+                  it->second->second.c_str(), hits_, misses_);
+        return it->second->second;
+    }
+
+    void put(uint64_t key, const std::string& text)
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        put_locked(key, text);
+    }
+
+    ~OcrCache()
+    {
+        if (!enabled()) return;
+        LOG_INFO("[ocr_cache] hits=%zu  misses=%zu  entries=%zu\n", hits_, misses_, lru_.size());
+        save();
+    }
+
+private:
+    using Entry = std::pair<uint64_t, std::string>;
+    static constexpr char kMagic[8] = {'O','C','R','C','A','C','H','2'};   // bump when keys change
+
+    OcrCache()
+        : cap_(CFG_BOOL("ocr_cache", true) ? size_t(std::max(0, CFG_INT("ocr_cache_size", 4096))) : 0),
+          file_(CFG_STR("ocr_cache_file", ""))
+    {
+        load();
+    }
+    OcrCache(const OcrCache&) = delete;
+    OcrCache& operator=(const OcrCache&) = delete;
+
+    void put_locked(uint64_t key, const std::string& text)
+    {
+        if (!cap_) return;
+        auto it = map_.find(key);
+        if (it != map_.end()) {
+            it->second->second = text;
+            lru_.splice(lru_.begin(), lru_, it->second);
+            return;
+        }
+        lru_.emplace_front(key, text);
+        map_[key] = lru_.begin();
+        if (lru_.size() > cap_) {
+            map_.erase(lru_.back().first);
+            lru_.pop_back();
+        }
+    }
+
+    /* [magic] { u64 key, u32 len, bytes }*  – oldest first */
+    void load()
+    {
+        if (!enabled() || file_.empty()) return;
+        std::ifstream in(file_, std::ios::binary);
+        if (!in) return;
+        char magic[8] = {};
+        if (!in.read(magic, sizeof magic) || std::memcmp(magic, kMagic, sizeof kMagic) != 0) {
+            LOG_WARN("[ocr_cache] %s is not a current OCR cache – ignored\n", file_.c_str());
+            return;
+        }
+        uint64_t key; uint32_t len; std::string txt;
+        while (in.read(reinterpret_cast<char*>(&key), sizeof key)
+            && in.read(reinterpret_cast<char*>(&len), sizeof len)) {
+            txt.resize(len);
+            if (len && !in.read(txt.data(), len)) break;
+            put_locked(key, txt);
+        }
+        LOG_INFO("[ocr_cache] loaded %zu entries from %s\n", lru_.size(), file_.c_str());
+    }
+
+    void save()
+    {
+        if (file_.empty()) return;
+        std::ofstream out(file_, std::ios::binary | std::ios::trunc);
+        if (!out) { LOG_WARN("[ocr_cache] cannot write %s\n", file_.c_str()); return; }
+        out.write(kMagic, sizeof kMagic);
+        for (auto it = lru_.rbegin(); it != lru_.rend(); ++it) {
+            uint32_t len = uint32_t(it->second.size());
+            out.write(reinterpret_cast<const char*>(&it->first), sizeof it->first);
+            out.write(reinterpret_cast<const char*>(&len), sizeof len);
+            out.write(it->second.data(), len);
+        }
+    }
+
+    size_t                                                   cap_;
+    std::string                                              file_;
+    std::list<Entry>                                         lru_;
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> map_;
+    size_t                                                   hits_ = 0, misses_ = 0;
+    std::mutex                                               mu_;
+};
+
+/*──────────────────────────── scan strategies ──────────────────────────────
+ *  How the phrase locator drives Tesseract (scan_strategy in .config):
+ *    sparse              one PSM_SPARSE_TEXT pass
+ *    sparse_then_block   sparse, then PSM_SINGLE_BLOCK only if nothing hit
+ *    block_then_sparse   the other way round
+ *    two_pass            the old locator: a discarded pass in the engine's
+ *                        mode, then sparse (kept as a benchmark baseline) */
+struct ScanStrategy {
+    const char*            name;
+    tesseract::PageSegMode primary;
+    tesseract::PageSegMode fallback;     // PSM_COUNT = none
+    bool                   warmup;       // extra, discarded first pass
+};
+
+inline const std::vector<ScanStrategy>& scan_strategies()
+{
+    static const std::vector<ScanStrategy> all = {
+        { "sparse",            tesseract::PSM_SPARSE_TEXT,  tesseract::PSM_COUNT,       false },
+        { "sparse_then_block", tesseract::PSM_SPARSE_TEXT,  tesseract::PSM_SINGLE_BLOCK, false },
+        { "block_then_sparse", tesseract::PSM_SINGLE_BLOCK, tesseract::PSM_SPARSE_TEXT,  false },
+        { "two_pass",          tesseract::PSM_SPARSE_TEXT,  tesseract::PSM_COUNT,       true  },
+    };
+    return all;
+}
+
+inline const ScanStrategy& scan_strategy(const std::string& name)
+{
+    for (const ScanStrategy& st : scan_strategies())
+        if (name == st.name) return st;
+    LOG_WARN("[scan] unknown strategy '%s' – using sparse_then_block\n", name.c_str());
+    return scan_strategies()[1];
+}
+
+struct ScanOptions {
+    ScanStrategy strategy   = scan_strategy(CFG_STR("scan_strategy", "sparse_then_block"));
+    double       conf_thr   = 60;
+    bool         first_only = false;         // the caller wants one box, stop there
+    int          max_edits  = CFG_INT("scan_max_edits", -1);   // -1 = one per 5 chars
+};
+
+/*──────────────────────────────  OCR profiles  ─────────────────────────────
+ *  Named per-field settings from .config, picked by name on OCR lines:
+ *      ocr_profiles=digits,item_name,free_text
+ *      ocr_profile_<name>_whitelist=0123456789 .,-
+ *      ocr_profile_<name>_psm=single_line     (auto | single_line | single_word
+ *                                              | single_block | sparse | <number>)
+ *      ocr_profile_<name>_dpi=300
+ *      ocr_profile_<name>_binarize=global     (config | none | global | adaptive)
+ *      ocr_profile_<name>_vars=classify_bln_numeric_mode:1;…
+ *  Everything is applied with SetVariable on an already initialised engine,
+ *  so switching never re-Inits. Init-only parameters (load_*_dawg) can't be
+ *  switched that way: dictionary behaviour goes through runtime variables
+ *  such as language_model_penalty_non_dict_word.                          */
+struct OcrProfile {
+    enum class Bin { Config, None, Global, Adaptive };
+
+    std::string            name;
+    tesseract::PageSegMode psm = tesseract::PSM_COUNT;     // PSM_COUNT = by ROI height
+    Bin                    bin = Bin::Config;
+    bool                   glyph = false;                   // try the glyph atlas first
+    enum class Type { Text, Int, Decimal };
+    Type                   type = Type::Text;               // what OCR … into var stores
+    std::vector<std::pair<std::string, std::string>> vars;  // whitelist / dpi included
+    uint64_t               salt = 0;                        // hash of the settings above (OcrCache)
+};
+
+class OcrProfiles {
+public:
+    static OcrProfiles& get()
+    {
+        static OcrProfiles p; return p;
+    }
+
+    /* nullptr for "" (engine defaults) and for unknown names */
+    const OcrProfile* find(const std::string& name) const
+    {
+        if (name.empty()) return nullptr;
+        auto it = map_.find(name);
+        if (it != map_.end()) return &it->second;
+        LOG_WARN("[ocr_profile] unknown profile '%s' – using defaults\n", name.c_str());
+        return nullptr;
+    }
+
+    bool any_glyph() const
+    {
+        return std::any_of(map_.begin(), map_.end(), [](const auto& kv) { return kv.second.glyph; });
+    }
+
+private:
+    OcrProfiles()
+    {
+        std::stringstream list(CFG_STR("ocr_profiles", ""));
+        std::string name;
+        while (std::getline(list, name, ',')) {
+            name = du::trim(name);
+            if (name.empty()) continue;
+            const std::string k = "ocr_profile_" + name + "_";
+            OcrProfile p; p.name = name;
+
+            if (std::string wl = CFG_STR(k + "whitelist", ""); !wl.empty())
+                p.vars.push_back({ "tessedit_char_whitelist", wl });
+            if (int dpi = CFG_INT(k + "dpi", 0); dpi > 0)
+                p.vars.push_back({ "user_defined_dpi", std::to_string(dpi) });
+
+            std::stringstream vs(CFG_STR(k + "vars", ""));
+            std::string kv;
+            while (std::getline(vs, kv, ';')) {
+                auto c = kv.find(':');
+                if (c == std::string::npos) continue;
+                p.vars.push_back({ du::trim(kv.substr(0, c)), du::trim(kv.substr(c + 1)) });
+            }
+
+            p.psm = parse_psm(CFG_STR(k + "psm", "auto"));
+
+            std::string bin = CFG_STR(k + "binarize", "config");
+            p.bin = bin == "none"     ? OcrProfile::Bin::None
+                  : bin == "global"   ? OcrProfile::Bin::Global
+                  : bin == "adaptive" ? OcrProfile::Bin::Adaptive
+                  :                     OcrProfile::Bin::Config;
+
+            p.glyph = CFG_STR(k + "engine", "tesseract") == "glyph";
+
+            std::string type = CFG_STR(k + "type", "text");
+            p.type = type == "int"     ? OcrProfile::Type::Int
+                   : type == "decimal" ? OcrProfile::Type::Decimal
+                   :                     OcrProfile::Type::Text;
+
+            std::string id = name + '|' + std::to_string(int(p.psm)) + '|' + std::to_string(int(p.bin))
+                           + '|' + std::to_string(int(p.glyph));
+            for (const auto& [vk, vv] : p.vars) id += '|' + vk + '=' + vv;
+            p.salt = detail::hash_bytes(id.data(), id.size(), 0);
+
+            LOG_INFO("[ocr_profile] %s: psm=%d  %zu variable(s)%s\n", name.c_str(), int(p.psm),
+                     p.vars.size(), p.glyph ? "  glyph first" : "");
+            map_[name] = std::move(p);
+        }
+    }
+
+    static tesseract::PageSegMode parse_psm(const std::string& s)
+    {
+        if (s == "single_line")  return tesseract::PSM_SINGLE_LINE;
+        if (s == "single_word")  return tesseract::PSM_SINGLE_WORD;
+        if (s == "single_block") return tesseract::PSM_SINGLE_BLOCK;
+        if (s == "sparse")       return tesseract::PSM_SPARSE_TEXT;
+        if (!s.empty() && std::isdigit(static_cast<unsigned char>(s[0])))
+            return tesseract::PageSegMode(std::stoi(s));
+        return tesseract::PSM_COUNT;
+    }
+
+    std::map<std::string, OcrProfile> map_;
+};
+
+/*──────────────────────────────  glyph atlas  ──────────────────────────────*/
+/* Templates for the game's bitmap fonts (built by glyph_harvest); profiles
+ * with engine=glyph read through it and fall back to Tesseract on weak reads */
+class GlyphAtlas {
+public:
+    static GlyphAtlas& get()
+    {
+        static GlyphAtlas a; return a;
+    }
+
+    /* std::nullopt = no atlas, unknown glyph or below glyph_min_conf */
+    std::optional<std::string> read(const cv::Mat& img) const
+    {
+        if (atlas_.empty() || img.empty() || img.depth() != CV_8U) return std::nullopt;
+        glyph::Result r = glyph::read(atlas_, img.data, img.cols, img.rows, img.step,
+                                      img.channels());
+        if (r.text.empty() || r.min_conf < min_conf_) {
+            ++fallbacks_;
+            LOG_DEBUG("[glyph] '%s' conf %.2f – falling back to tesseract\n",
+                      r.text.c_str(), r.min_conf);
+            return std::nullopt;
+        }
+        ++hits_;
+        LOG_DEBUG("[glyph] '%s' conf %.2f\n", r.text.c_str(), r.min_conf);
+        return r.text;
+    }
 
-    api.SetImage(img.data, img.cols, img.rows,
-                 img.channels(), (int)img.step);
-}
+private:
+    GlyphAtlas() : min_conf_(float(CFG_DBL("glyph_min_conf", 0.85)))
+    {
+        const std::string path = CFG_STR("glyph_atlas", "");
+        if (path.empty() || !atlas_.load(path) || atlas_.empty())
+            LOG_WARN("[glyph] no atlas at '%s' – engine=glyph profiles read with tesseract "
+                     "(build one with glyph_harvest)\n", path.c_str());
+    }
+    ~GlyphAtlas()
+    {
+        if (hits_ || fallbacks_)
+            LOG_INFO("[glyph] %zu read(s), %zu handed to tesseract\n",
+                     size_t(hits_), size_t(fallbacks_));
+    }
 
-} // namespace detail
+    glyph::Atlas                atlas_;
+    float                       min_conf_;
+    mutable std::atomic<size_t> hits_{ 0 }, fallbacks_{ 0 };
+};
 
 /*──────────────────────────────  OCR engine  ───────────────────────────────*/
 class Engine {
@@ -138,32 +1275,163 @@ public:
 
     std::string read(HWND hwnd);
     std::string read(HWND hwnd, tesseract::PageSegMode psm);
-    std::string read(HWND hwnd, const RECT& r);
-    std::string read(HWND hwnd, const cv::Mat& prev, const RECT& r);
+    std::string read(HWND hwnd, const RECT& r, const std::string& profile = "");
+    std::string read(HWND hwnd, const cv::Mat& prev, const RECT& r, const std::string& profile = "");
     std::string read(HWND hwnd, const cv::Mat& prev, tesseract::PageSegMode psm);
 
     /* return bounding rects (window-relative) whose recognised text contains
        the query substring (case-insensitive).                               */
     std::vector<RECT> find(HWND hwnd,
                             std::string_view query,
-                            double conf_threshold = 60);
+                            double conf_threshold = 60,
+                            bool first_only = false);
     std::vector<RECT> find(HWND hwnd,
                             const RECT& roi,
                             std::string_view query,
-                            double conf_thr = 60);
+                            double conf_thr = 60,
+                            bool first_only = false);
+    /* locate in an image already at hand (saved frames, benchmarks) */
+    std::vector<RECT> find(const cv::Mat& img,
+                            std::string_view query,
+                            const ScanOptions& opt);
+    /* several phrases, one capture and one Recognize: phrase → boxes
+       (absent / empty when not found); roi {} = whole client area     */
+    std::map<std::string, std::vector<RECT>> find_many(const FramePtr& f,
+                            const RECT& roi,
+                            const std::vector<std::string_view>& queries,
+                            double conf_thr = 60,
+                            bool first_only = false);
+    std::map<std::string, std::vector<RECT>> find_many(HWND hwnd,
+                            const RECT& roi,
+                            const std::vector<std::string_view>& queries,
+                            double conf_thr = 60,
+                            bool first_only = false);
+
+    /* OCR several rectangles of one frame at once, spread over the pool;
+       results come back in the order of `rois`                         */
+    std::vector<std::string> read_regions(const FramePtr& f, const std::vector<RECT>& rois,
+                                          const std::vector<std::string>& profiles = {});
+    std::vector<std::string> read_regions(HWND hwnd, const std::vector<RECT>& rois,
+                                          const std::vector<std::string>& profiles = {});
+
+    size_t pool_size() const { return pool_.size(); }
 
 private:
-    Engine()  { init(); }
-    ~Engine() { api_.End(); }
+    friend class OcrSession;
+
+    /* one initialised TessBaseAPI; the pool hands them out one caller at a time */
+    struct Worker {
+        tesseract::TessBaseAPI             api;
+        const OcrProfile*                  profile = nullptr;   // currently applied
+        std::map<std::string, std::string> defaults;            // values before any profile
+        uint64_t                           image = 0;           // OcrSession plane set, 0 = other
+        dr::OcrSource                      source = dr::OcrSource::Tesseract;  // of the last read_
+    };
+
+    /* OcrCache salt: everything besides the pixels that shapes the text –
+       the cache outlives the run, so a .config edit or a Tesseract upgrade
+       must change the key                                                  */
+    static uint64_t cache_salt(Worker& w, tesseract::PageSegMode psm, const OcrProfile* prof)
+    {
+        static const uint64_t base = [] {
+            std::string id = tesseract::TessBaseAPI::Version();
+            for (const char* k : { "binarize_for_ocr", "adaptative_binarization", "binary_image_threshold",
+                                   "binarization_blockSize", "binarization_c" })
+                id += std::string("|") + k + '=' + CFG_STR(k, "");
+            return detail::hash_bytes(id.data(), id.size(), 0);
+        }();
+        const char* wl   = w.api.GetStringVariable("tessedit_char_whitelist");
+        const char* lang = w.api.GetInitLanguagesAsString();
+        uint64_t salt = detail::mix64(base ^ (uint64_t(psm) + 1));
+        if (prof) salt = detail::hash_bytes(prof->name.data(), prof->name.size(), salt ^ prof->salt);
+        if (wl)   salt = detail::hash_bytes(wl,   std::strlen(wl),   salt);
+        if (lang) salt = detail::hash_bytes(lang, std::strlen(lang), salt);
+        return salt;
+    }
+
+    /* switch a worker to `p` (nullptr = engine defaults) – SetVariable only */
+    static void apply(Worker& w, const OcrProfile* p)
+    {
+        if (w.profile == p) return;
+        if (w.profile)
+            for (const auto& [k, v] : w.profile->vars)
+                w.api.SetVariable(k.c_str(), w.defaults[k].c_str());
+        if (p)
+            for (const auto& [k, v] : p->vars) {
+                if (!w.defaults.count(k)) {
+                    std::string def;
+                    w.api.GetVariableAsString(k.c_str(), &def);
+                    w.defaults[k] = def;
+                }
+                if (!w.api.SetVariable(k.c_str(), v.c_str()))
+                    LOG_WARN("[ocr_profile] %s: cannot set %s\n", p->name.c_str(), k.c_str());
+            }
+        w.profile = p;
+    }
+
+    class Lease {
+    public:
+        Lease(Engine& e, Worker* w) : e_(e), w_(w) {}
+        ~Lease() { e_.release(w_); }
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        tesseract::TessBaseAPI& api() { return w_->api; }
+        Worker&                 worker() { return *w_; }
+    private:
+        Engine& e_;
+        Worker* w_;
+    };
+
+    Lease lease()
+    {
+        std::unique_lock<std::mutex> lock(mu_);
+        cv_.wait(lock, [this]{ return !free_.empty(); });
+        Worker* w = free_.back(); free_.pop_back();
+        return Lease(*this, w);
+    }
+    void release(Worker* w)
+    {
+        { std::lock_guard<std::mutex> lock(mu_); free_.push_back(w); }
+        cv_.notify_one();
+    }
+
+    Engine()
+    {
+        const int n = std::max(1, CFG_INT("ocr_pool_size", 1));
+        auto t0 = std::chrono::steady_clock::now();
+
+        /* each Init loads the traineddata on its own – do them side by side */
+        std::vector<std::exception_ptr> err(n);
+        std::vector<std::thread>        th;
+        for (int i = 0; i < n; ++i) pool_.push_back(std::make_unique<Worker>());
+        for (int i = 0; i < n; ++i)
+            th.emplace_back([this, &err, i] {
+                try { init(pool_[i]->api); } catch (...) { err[i] = std::current_exception(); }
+            });
+        for (auto& t : th) t.join();
+        for (auto& e : err) if (e) std::rethrow_exception(e);
+
+        tessdata::release_files();
+
+        for (auto& w : pool_) free_.push_back(w.get());
+        std::chrono::duration<double, std::milli> d = std::chrono::steady_clock::now() - t0;
+        const std::string lang = CFG_STR("language", "eng");
+        LOG_INFO("[ocr] engine pool ready: %d engine(s), language %s (%s), %.0f ms\n",
+                 n, lang.c_str(), tessdata::embedded(lang) ? "embedded" : "languages_path", d.count());
+    }
+    ~Engine() { for (auto& w : pool_) w->api.End(); }
     Engine(const Engine&) = delete;
     Engine& operator=(const Engine&) = delete;
 
-    void init() {
+    void init(tesseract::TessBaseAPI& api_) {
         std::string path = CFG_STR("languages_path", "./tessdata");
         std::string lang = CFG_STR("language"      , "eng");
-        LOG_INFO("USING LANGUAGE: %s\n", lang.c_str());
+        LOG_DEBUG("USING LANGUAGE: %s\n", lang.c_str());
         
-        if (api_.Init(path.c_str(), lang.c_str(), tesseract::OEM_LSTM_ONLY))
+        /* models come through tessdata::reader – embedded blob or one shared
+           read of languages_path, never a file open per engine            */
+        if (api_.Init(path.c_str(), 0, lang.c_str(), tesseract::OEM_LSTM_ONLY,
+                      nullptr, 0, nullptr, nullptr, false, &tessdata::reader))
             throw std::runtime_error("Tesseract init failed");
             
         api_.SetVariable("debug_file", "nul");                 // silence Leptonica
@@ -193,17 +1461,48 @@ private:
 public:
     std::string read_(cv::Mat img, tesseract::PageSegMode psm)
     {
+        Lease w = lease();
+        return read_(w.worker(), img, psm);
+    }
+private:
+    std::string read_(Worker& wk, cv::Mat img, tesseract::PageSegMode psm,
+                      const OcrProfile* prof = nullptr)
+    {
+        wk.source = dr::OcrSource::Glyph;
+        if (prof && prof->glyph)
+            if (auto txt = GlyphAtlas::get().read(img)) return *txt;
+        wk.source = dr::OcrSource::Tesseract;
+
+        tesseract::TessBaseAPI& api_ = wk.api;
+        apply(wk, prof);
+        if (prof && prof->psm != tesseract::PSM_COUNT) psm = prof->psm;
+
         cv::Mat bw;
 
-        if(CFG_BOOL("binarize_for_ocr", "false")) {
+        using Bin = OcrProfile::Bin;
+        const Bin bin = prof ? prof->bin : Bin::Config;
+        if (bin == Bin::Global) {
+            bw  = detail::binarise(img);
+        } else if (bin == Bin::Adaptive) {
+            bw  = detail::binarise_adapt(img);
+        } else if (bin == Bin::Config && CFG_BOOL("binarize_for_ocr", "false")) {
             bw  = detail::binarise_wrap(img);
         } else {
             bw  = img.clone();
         }
 
         if(CFG_BOOL("debug_img",false)) {
-            detail::save_debug_image(bw,  "ocr");
+            detail::save_debug_image(cv::Mat(bw), "ocr");   // bw is only read from here on
         }
+
+        /* same pixels + same settings → same text */
+        OcrCache& cache = OcrCache::get();
+        uint64_t key = 0;
+        if (cache.enabled()) {
+            key = detail::hash_mat(bw, cache_salt(wk, psm, prof));
+            if (auto hit = cache.find(key)) return *hit;
+        }
+
         auto old = api_.GetPageSegMode();
         api_.SetPageSegMode(psm);
         
@@ -212,6 +1511,7 @@ public:
         // detail::set_image(api_, upscale);
         
         detail::set_image(api_, bw);
+        wk.image = 0;
         std::unique_ptr<char[]> txt(api_.GetUTF8Text());
         
         api_.SetPageSegMode(old);
@@ -222,11 +1522,14 @@ public:
         if (!s.empty() && (s.back() == '\n' || s.back() == '\r'))
             s.pop_back();
 
+        if (cache.enabled()) cache.put(key, s);
         return s;
     }
-private:
-    tesseract::TessBaseAPI api_;
-    std::mutex             mu_;
+
+    std::vector<std::unique_ptr<Worker>> pool_;
+    std::vector<Worker*>                 free_;
+    std::mutex                           mu_;
+    std::condition_variable              cv_;
 };
 
 /*─────────────────────────────  implementation  ───────────────────────────*/
@@ -236,44 +1539,60 @@ inline std::string Engine::read(HWND hwnd)
 }
 inline std::string Engine::read(HWND hwnd, tesseract::PageSegMode psm)
 {
-    std::lock_guard<std::mutex> lock(mu_);
+    Lease w = lease();
     
-    cv::Mat win = detail::capture(hwnd);
+    FramePtr f = frame(hwnd);
     
-    return read_(win, psm);
+    std::string s = read_(w.worker(), f->img, psm);
+    return detail::record_ocr(f->rc, std::move(s), w.worker().source);
 }
-inline std::string Engine::read(HWND hwnd, const RECT& roi)
+inline std::string Engine::read(HWND hwnd, const RECT& roi, const std::string& profile)
 {
-    std::lock_guard<std::mutex> lock(mu_);
+    Lease w = lease();
 
-    cv::Mat win = detail::capture(hwnd);
-    cv::Mat region = roi.right ? win(cv::Rect(roi.left, roi.top,
-                                              roi.right - roi.left,
-                                              roi.bottom - roi.top)) : win;
+    FramePtr f = roi.right ? frame(hwnd, roi) : frame(hwnd);
+    if (!f) return "";
+    const cv::Mat& region = f->img;
     
-    return read_(region, 
-        (roi.bottom - roi.top) < 60 ? tesseract::PSM_SINGLE_LINE : tesseract::PSM_SINGLE_BLOCK
+    std::string s = read_(w.worker(), region, 
+        (roi.bottom - roi.top) < 60 ? tesseract::PSM_SINGLE_LINE : tesseract::PSM_SINGLE_BLOCK,
+        OcrProfiles::get().find(profile)
     );
+    return detail::record_ocr(f->rc, std::move(s), w.worker().source);
 }
 /* diff-OCR that stays simple and never hits the channel-mismatch crash */
 inline std::string Engine::read(HWND hwnd,
     const cv::Mat& prev,
-    const RECT& roi)
+    const RECT& roi,
+    const std::string& profile)
 {
-    std::lock_guard<std::mutex> lock(mu_);
+    const OcrProfile* prof = OcrProfiles::get().find(profile);
+    Lease w = lease();
 
-    /* 1. capture new frame */
-    cv::Mat cur = detail::capture(hwnd);
+    /* 1. current pixels of the ROI only (shared with the rest of this step) */
+    FramePtr f = roi.right ? frame(hwnd, roi) : frame(hwnd);
+    if (!f) return "";
+    const cv::Mat& cur = f->img;
+    const cv::Rect  box = detail::to_rect(f->rc);
+
+    /* 2. tesseract mode by height */
+    tesseract::PageSegMode psm =
+        (roi.bottom - roi.top) < 60
+        ? tesseract::PSM_SINGLE_LINE
+        : tesseract::PSM_SINGLE_BLOCK;
 
-    /* 2. if we don’t have a valid previous frame, fall back to normal read */
-    if (prev.empty() || prev.size() != cur.size() || prev.type() != cur.type())
-        return read(hwnd, roi);                   // reuse your existing overload
+    /* 3. if we don’t have a valid previous frame, fall back to normal read */
+    if (prev.empty() || prev.type() != cur.type()
+        || (box & cv::Rect(0, 0, prev.cols, prev.rows)) != box) {
+        std::string s = read_(w.worker(), cur, psm, prof);
+        return detail::record_ocr(f->rc, std::move(s), w.worker().source);
+    }
 
-    /* 3. absolute difference (both are CV_8UC4) */
+    /* 4. absolute difference of the ROI (both are CV_8UC4) */
     cv::Mat diff;
-    cv::absdiff(cur, prev, diff);                // diff is 4-channel BGRA
+    cv::absdiff(cur, prev(box), diff);           // diff is 4-channel BGRA
 
-    /* 4. make alpha channel fully opaque so PNG preview isn’t transparent */
+    /* 5. make alpha channel fully opaque so PNG preview isn’t transparent */
     {
         std::vector<cv::Mat> ch; cv::split(diff, ch);   // BGRA → {B,G,R,A}
         ch[3].setTo(255);                               // alpha = 255 everywhere
@@ -281,179 +1600,441 @@ inline std::string Engine::read(HWND hwnd,
     }
 
     if(CFG_BOOL("debug_img",false)) {
-        detail::save_debug_image(cur,  "curr");
-        detail::save_debug_image(prev, "prev");
-        detail::save_debug_image(diff, "diff");
+        detail::save_debug_image(cur,       "curr");
+        detail::save_debug_image(prev(box), "prev");
+        detail::save_debug_image(cv::Mat(diff), "diff");   // only read from here on
     }
 
-    /* 5. crop to ROI if given */
-    cv::Mat region = roi.right
-        ? diff(cv::Rect(roi.left, roi.top,
-            roi.right  - roi.left,
-            roi.bottom - roi.top))
-        : diff;
+    /* 6. OCR the diff – recorded as such, its pixels are not the frame's */
+    return detail::record_ocr(f->rc, read_(w.worker(), diff, psm, prof), dr::OcrSource::Diff);
+}
 
-    /* 6. choose PSM by height and OCR */
-    tesseract::PageSegMode psm =
-        (roi.bottom - roi.top) < 60
-        ? tesseract::PSM_SINGLE_LINE
-        : tesseract::PSM_SINGLE_BLOCK;
+/*──────────────────────────── phrase locator ───────────────────────────────*/
+namespace detail {
+/* one recognition pass: the words (with boxes) as one simplified stream,
+ * every pending pattern searched in it with edit-distance tolerance; a
+ * match is the union box of the words it covers, kept when their mean
+ * confidence reaches conf_thr. Patterns that hit leave `pending`.        */
+inline void scan_pass(tesseract::TessBaseAPI& api,
+                      tesseract::PageSegMode psm,
+                      const RECT&        roi_shift,
+                      const std::vector<fuzzy::Pattern>& pats,
+                      std::vector<size_t>& pending,
+                      const ScanOptions& opt,
+                      std::vector<std::vector<RECT>>& hits)
+{
+    api.SetPageSegMode(psm);
+    api.Recognize(nullptr);
 
-    return read_(region, psm);      // ← your existing helper
+    std::unique_ptr<tesseract::ResultIterator> it(api.GetIterator());
+    if (!it) {
+        LOG_WARN("[scan] no result iterator (psm=%d)\n", int(psm));
+        return;
+    }
+
+    const tesseract::PageIteratorLevel lvl = tesseract::RIL_WORD;
+    fuzzy::Stream<RECT> words;
+    for (; !it->Empty(lvl); it->Next(lvl)) {
+        std::unique_ptr<char[]> w(it->GetUTF8Text(lvl));
+        if (!w) continue;
+        std::string word_s = du::simplify(w.get());
+        if (word_s.empty()) continue;
+        int l, t, r, b;
+        it->BoundingBox(lvl, &l, &t, &r, &b);
+        words.add(word_s, RECT{ l + roi_shift.left, t + roi_shift.top, r + roi_shift.left, b + roi_shift.top },
+                  it->Confidence(lvl), it->IsAtBeginningOf(tesseract::RIL_TEXTLINE));
+    }
+    LOG_DEBUG("[scan] psm=%d: %zu words, %zu chars\n", int(psm), words.words.size(), words.text.size());
+
+    std::vector<size_t> still;
+    for (size_t q : pending) {
+        const fuzzy::Pattern& pat = pats[q];
+        for (const fuzzy::Match& mt : pat.find(words.text)) {
+            auto [first, last] = words.span(mt);
+            if (first < 0) continue;
+            RECT box = words.words[first].box;
+            float conf = 0.f;
+            for (int i = first; i <= last; ++i) {
+                const RECT& wb = words.words[i].box;
+                box = RECT{ std::min(box.left, wb.left),   std::min(box.top, wb.top),
+                            std::max(box.right, wb.right), std::max(box.bottom, wb.bottom) };
+                conf += words.words[i].conf;
+            }
+            conf /= float(last - first + 1);
+            if (conf < opt.conf_thr) continue;
+
+            hits[q].push_back(box);
+            LOG_INFO("[scan] match found: '%s' ~ '%s' (%d edit(s)) conf=%.1f at (%ld,%ld,%ld,%ld) psm=%d\n",
+                     pat.text().c_str(), words.text.substr(mt.begin, mt.end - mt.begin).c_str(),
+                     mt.edits, conf, long(box.left), long(box.top), long(box.right), long(box.bottom), int(psm));
+            if (opt.first_only) break;
+        }
+        if (hits[q].empty()) still.push_back(q);
+    }
+    pending.swap(still);
 }
+} // namespace detail
 
-/*──────────────────────────── helper that does the actual scan ────────────*/
-/*────────────────────────── smarter OCR phrase locator ────────────────────*/
-inline std::vector<RECT> scan(cv::Mat img,
+/* locate several queries in img (already pre-processed) with one recognition
+ * pass; the fallback PSM runs only for queries the primary one missed.
+ * Boxes come back per query, in the order of `queries`.                    */
+inline std::vector<std::vector<RECT>> scan(cv::Mat img,
     const RECT& roi_shift,        // (0,0,0,0) for full-window
-    std::string_view   query,
-    double             conf_thr,
+    const std::vector<std::string>& queries,
+    const ScanOptions& opt,
     tesseract::TessBaseAPI& api)
 {
-    LOG_INFO("[scan] start: roi_shift=(%d,%d,%d,%d), query='%.*s', conf_thr=%.2f\n",
-             roi_shift.left, roi_shift.top, roi_shift.right, roi_shift.bottom,
-             static_cast<int>(query.size()), query.data(), conf_thr);
-
-    std::vector<RECT> hits;                   // final result
-    const std::string expected = du::simplify(query);
-    LOG_INFO("[scan] simplified query: '%s'\n", expected.c_str());
+    std::vector<fuzzy::Pattern> pats;
+    std::vector<size_t>         pending;
+    for (const std::string& q : queries) {
+        pats.emplace_back(du::simplify(q), opt.max_edits);
+        if (!pats.back().text().empty()) pending.push_back(pats.size() - 1);
+        LOG_INFO("[scan] query='%s' max_edits=%d strategy=%s conf_thr=%.1f%s\n",
+                 pats.back().text().c_str(), pats.back().max_edits(), opt.strategy.name,
+                 opt.conf_thr, opt.first_only ? " first_only" : "");
+    }
 
     if(CFG_BOOL("debug_img",false)) {
         detail::save_debug_image(img, "scan_input");
     }
 
-    /* run Tesseract on the provided image ------------------------------- */
-    LOG_INFO("[scan] running initial recognition...\n");
+    std::vector<std::vector<RECT>> hits(queries.size());
+    auto old_psm = api.GetPageSegMode();          // keep caller’s mode
     detail::set_image(api, img);
-    api.Recognize(nullptr);
 
-    using Word = struct { std::string txt; std::string txt_s; RECT box; };
-    std::vector<Word> words;
+    const ScanStrategy& st = opt.strategy;
+    if (st.warmup) {                              // legacy: discarded pass in the caller's mode
+        api.Recognize(nullptr);
+    }
+    detail::scan_pass(api, st.primary, roi_shift, pats, pending, opt, hits);
+    if (!pending.empty() && st.fallback != tesseract::PSM_COUNT) {
+        LOG_DEBUG("[scan] %zu quer(ies) missed with psm=%d – fallback psm=%d\n",
+                  pending.size(), int(st.primary), int(st.fallback));
+        detail::scan_pass(api, st.fallback, roi_shift, pats, pending, opt, hits);
+    }
 
-    tesseract::ResultIterator* it = api.GetIterator();
-    const tesseract::PageIteratorLevel lvl = tesseract::RIL_WORD;
+    api.SetPageSegMode(old_psm);                  // restore
+    size_t n = 0; for (const auto& h : hits) n += h.size();
+    LOG_INFO("[scan] %zu hit(s)\n", n);
+    return hits;
+}
 
-    if (!it) {
-        LOG_WARN("[scan] no result iterator after initial recognition.\n");
-    } else {
-        int word_count = 0;
-        for (; !it->Empty(lvl); it->Next(lvl))
-        {
-            float confidence = it->Confidence(lvl);
-            LOG_DEBUG("[scan] iterating word, confidence=%.2f\n", confidence);
+/* one query – see above */
+inline std::vector<RECT> scan(cv::Mat img,
+    const RECT& roi_shift,
+    std::string_view   query,
+    const ScanOptions& opt,
+    tesseract::TessBaseAPI& api)
+{
+    return scan(img, roi_shift, std::vector<std::string>{ std::string(query) }, opt, api).front();
+}
 
-            if (confidence < conf_thr) {
-                LOG_DEBUG("[scan] word skipped due to low confidence: %.2f\n", confidence);
-                continue;
-            }
 
-            const char* w = it->GetUTF8Text(lvl);
-            if (!w) {
-                LOG_WARN("[scan] nullptr returned from GetUTF8Text\n");
-                continue;
-            }
-            LOG_EVENT("[scan] word='%s' (confidence=%.2f)\n", w, confidence);
-
-            int l, t, r, b;
-            it->BoundingBox(lvl, &l, &t, &r, &b);
-            words.push_back({
-                std::string(w),
-                du::simplify(w),
-                RECT{ l + roi_shift.left, t + roi_shift.top,
-                      r + roi_shift.left, b + roi_shift.top }
-            });
-            delete[] w;
-            ++word_count;
-        }
-        LOG_INFO("[scan] extracted %d words from initial pass.\n", word_count);
-    }
+/*─────────────────────── find over entire window (unchanged API) ───────────*/
+inline std::vector<RECT> Engine::find(HWND hwnd,
+            std::string_view query,
+            double conf_thr,
+            bool first_only)
+{
+    Lease w = lease();
 
-    if(CFG_BOOL("debug_img",false)) {
-        detail::save_debug_image(img, "scan_input_fixed");
+    FramePtr f = frame(hwnd);
+    cv::Mat bw  = detail::binarise_wrap(f->img);
+    ScanOptions opt; opt.conf_thr = conf_thr; opt.first_only = first_only;
+    w.worker().image = 0;
+    return scan(bw, RECT{0,0,0,0}, query, opt, w.api());
+}
+
+/*─────────────────────── find inside a rectangle (NEW) ─────────────────────*/
+inline std::vector<RECT> Engine::find(HWND hwnd,
+            const RECT& roi,
+            std::string_view query,
+            double conf_thr,
+            bool first_only)
+{
+    Lease w = lease();
+
+    FramePtr f  = frame(hwnd, roi);                 // ROI pixels only
+    if (!f) return {};
+    cv::Mat  bw = detail::binarise_wrap(f->img);
+
+    ScanOptions opt; opt.conf_thr = conf_thr; opt.first_only = first_only;
+    w.worker().image = 0;
+    return scan(bw, f->rc, query, opt, w.api());
+}
+
+inline std::vector<RECT> Engine::find(const cv::Mat& img,
+            std::string_view query,
+            const ScanOptions& opt)
+{
+    Lease w = lease();
+    w.worker().image = 0;
+    return scan(detail::binarise_wrap(img), RECT{0,0,0,0}, query, opt, w.api());
+}
+
+/*─────────────────────── several phrases, one pass ─────────────────────────*/
+inline std::map<std::string, std::vector<RECT>> Engine::find_many(const FramePtr& f,
+            const RECT& roi,
+            const std::vector<std::string_view>& queries,
+            double conf_thr,
+            bool first_only)
+{
+    std::map<std::string, std::vector<RECT>> out;
+    FramePtr c = roi.right > roi.left ? detail::crop(f, roi) : f;
+    if (!c || c->img.empty() || queries.empty()) return out;
+
+    Lease w = lease();
+    cv::Mat bw = detail::binarise_wrap(c->img);
+    ScanOptions opt; opt.conf_thr = conf_thr; opt.first_only = first_only;
+    w.worker().image = 0;
+    std::vector<std::vector<RECT>> hits =
+        scan(bw, c->rc, std::vector<std::string>(queries.begin(), queries.end()), opt, w.api());
+    for (size_t i = 0; i < queries.size(); ++i) {
+        auto& boxes = out[std::string(queries[i])];
+        boxes.insert(boxes.end(), hits[i].begin(), hits[i].end());
     }
+    return out;
+}
 
-    /* second pass ─ OCR with sparse mode */
-    LOG_INFO("[scan] starting second recognition pass (PSM_SPARSE_TEXT)...\n");
-    auto old_psm = api.GetPageSegMode();          // keep caller’s mode
-    api.SetPageSegMode(tesseract::PSM_SPARSE_TEXT);
+inline std::map<std::string, std::vector<RECT>> Engine::find_many(HWND hwnd,
+            const RECT& roi,
+            const std::vector<std::string_view>& queries,
+            double conf_thr,
+            bool first_only)
+{
+    FramePtr f = roi.right > roi.left ? frame(hwnd, roi) : frame(hwnd);
+    return find_many(f, RECT{}, queries, conf_thr, first_only);
+}
 
-    detail::set_image(api, img);
-    api.Recognize(nullptr);
+/*──────────────────────────── frame OCR session ────────────────────────────
+ *  Many fields of one frame: the frame's luma plane is converted once and
+ *  handed to each engine once (SetImage), then every field is only a
+ *  SetRectangle on it – no per-field crop, clone or colour conversion.
+ *
+ *  Binarisation moves to planes too: adaptive thresholding (local by
+ *  nature) runs once over the frame. Global binarisation splits each
+ *  field's own two colours: every such field writes its two-means mask
+ *  into its rectangle of one shared mask plane – the same pixels
+ *  Engine::read_ would binarise the crop to, so the same cache key and
+ *  text. A field whose colours are too close to split, or that overlaps
+ *  another masked field, still goes through Engine::read_ on its crop.
+ *
+ *  A session is valid for the frame it was opened on; callers drop it on
+ *  input (see frame()->input_seq).                                          */
+class OcrSession {
+public:
+    explicit OcrSession(FramePtr f) : f_(std::move(f)) {}
+    explicit OcrSession(HWND hwnd) : f_(so::frame(hwnd)) {}
+    /* only capture `area` (client coords) – every field must lie inside it */
+    OcrSession(HWND hwnd, const RECT& area) : f_(so::frame(hwnd, area)) {}
 
-    it = api.GetIterator();
+    const FramePtr& frame() const { return f_; }
+    bool covers(const RECT& r) const
+    {
+        return f_ && r.left >= f_->rc.left && r.top >= f_->rc.top
+                  && r.right <= f_->rc.right && r.bottom <= f_->rc.bottom;
+    }
 
-    if (!it) {
-        LOG_WARN("[scan] no result iterator after second recognition.\n");
-    } else {
-        int match_count = 0;
-        for (; !it->Empty(lvl); it->Next(lvl))
+    std::string read(const RECT& r, const std::string& profile = "")
+    {
+        Engine& eng = Engine::get();
+        Engine::Lease w = eng.lease();
+        return read_(w.worker(), r, OcrProfiles::get().find(profile));
+    }
+
+    /* spread over the pool: one SetImage per engine, then rectangles only */
+    std::vector<std::string> read(const std::vector<RECT>& rois,
+                                  const std::vector<std::string>& profiles = {})
+    {
+        std::vector<std::string> out(rois.size());
+        if (!f_ || rois.empty()) return out;
+
+        std::vector<const OcrProfile*> prof(rois.size(), nullptr);
+        for (size_t i = 0; i < rois.size() && i < profiles.size(); ++i)
+            prof[i] = OcrProfiles::get().find(profiles[i]);
+        for (size_t i = 0; i < rois.size(); ++i) {           // build before the threads
+            if (!global(prof[i])) plane(adaptive(prof[i]));
+            else if (covers(rois[i])) mask(field(rois[i]));
+        }
+
+        Engine& eng = Engine::get();
+        #pragma omp parallel num_threads(int(std::max<size_t>(1, std::min(eng.pool_size(), rois.size()))))
         {
-            float confidence = it->Confidence(lvl);
-            if (confidence < conf_thr) {
-                LOG_DEBUG("[scan] (pass 2) word skipped due to low confidence: %.2f\n", confidence);
-                continue;
-            }
+            Engine::Lease w = eng.lease();
+            #pragma omp for schedule(dynamic, 1)
+            for (int i = 0; i < int(rois.size()); ++i)
+                out[i] = read_(w.worker(), rois[i], prof[i]);
+        }
+        return out;
+    }
 
-            const char* w = it->GetUTF8Text(lvl);
-            if (!w) {
-                LOG_WARN("[scan] (pass 2) nullptr returned from GetUTF8Text\n");
-                continue;
-            }
+private:
+    struct Plane {
+        cv::Mat  img;
+        uint64_t id = 0;          // Worker::image tag
+    };
 
-            std::string word_s = du::simplify(w);
-            delete[] w;
+    /* two-means binarisation of the field itself – see Engine::read_ */
+    static bool global(const OcrProfile* p)
+    {
+        using Bin = OcrProfile::Bin;
+        const Bin bin = p ? p->bin : Bin::Config;
+        return bin == Bin::Global
+            || (bin == Bin::Config && CFG_BOOL("binarize_for_ocr", false)
+                                   && !CFG_BOOL("adaptative_binarization", false));
+    }
 
-            if (word_s.find(expected) != std::string::npos)
-            {
-                int l, t, r, b;
-                it->BoundingBox(lvl, &l, &t, &r, &b);
-                hits.push_back(RECT{ l + roi_shift.left, t + roi_shift.top,
-                                     r + roi_shift.left, b + roi_shift.top });
-
-                LOG_INFO("[scan] match found: word='%s' at (%d,%d,%d,%d)\n",
-                         word_s.c_str(), l, t, r, b);
-                ++match_count;
-            } else {
-                LOG_DEBUG("[scan] (pass 2) word '%s' does not match query '%s'\n",
-                          word_s.c_str(), expected.c_str());
+    static bool adaptive(const OcrProfile* p)
+    {
+        using Bin = OcrProfile::Bin;
+        const Bin bin = p ? p->bin : Bin::Config;
+        return bin == Bin::Adaptive
+            || (bin == Bin::Config && CFG_BOOL("binarize_for_ocr", false)
+                                   && CFG_BOOL("adaptative_binarization", false));
+    }
+
+    static uint64_t next_id()
+    {
+        static std::atomic<uint64_t> id{ 0 };
+        return ++id;
+    }
+
+    cv::Rect field(const RECT& r) const
+    {
+        return detail::to_rect(r) - cv::Point(f_->rc.left, f_->rc.top);
+    }
+
+    /* two-means mask of `box` written into the mask plane, once per field.
+       false when the field is not in the plane: its colours are too close
+       (Engine::read_ keeps the colour crop then) or it overlaps a field
+       already masked with its own split. Each new field gives the plane a
+       new id, so engines holding an older copy set it again.             */
+    bool mask(const cv::Rect& box)
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        const std::array<int, 4> k{ box.x, box.y, box.width, box.height };
+        if (auto it = masked_.find(k); it != masked_.end()) return it->second;
+
+        bool ok = f_->img.channels() >= 3;
+        for (const auto& [b, in] : masked_)
+            if (in && (cv::Rect(b[0], b[1], b[2], b[3]) & box).area() > 0) { ok = false; break; }
+        if (ok) {
+            if (mask_.img.empty()) mask_.img.create(f_->img.rows, f_->img.cols, CV_8UC1);
+            const cv::Mat src = f_->img(box);
+            cv::Mat       dst = mask_.img(box);
+            ok = detail::two_means_mask(src.data, src.cols, src.rows, src.step, src.channels(),
+                                        dst.data, dst.step, CFG_DBL("binary_image_threshold", 8.0));
+            if (ok) mask_.id = next_id();
+        }
+        masked_[k] = ok;
+        return ok;
+    }
+
+    /* luma of the frame, or its adaptive threshold – built on first use */
+    const Plane& plane(bool adapt)
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        Plane& p = adapt ? adapt_ : gray_;
+        if (p.img.empty() && f_ && !f_->img.empty()) {
+            if (gray_.img.empty()) {
+                const int ch = f_->img.channels();
+                if (ch == 1) gray_.img = f_->img;          // already mono
+                else cv::cvtColor(f_->img, gray_.img, ch == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+                gray_.id = next_id();
+            }
+            if (adapt) {
+                cv::adaptiveThreshold(gray_.img, adapt_.img, 255,
+                    cv::ADAPTIVE_THRESH_GAUSSIAN_C, cv::THRESH_BINARY,
+                    CFG_INT("binarization_blockSize", 11), CFG_INT("binarization_c", 2));
+                adapt_.id = next_id();
             }
         }
-        LOG_INFO("[scan] total matches found: %d\n", match_count);
+        return p;
     }
 
-    api.SetPageSegMode(old_psm);                  // restore
-    LOG_INFO("[scan] end, returning %zu hits.\n", hits.size());
+    std::string read_(Engine::Worker& wk, const RECT& r, const OcrProfile* prof)
+    {
+        if (!covers(r)) {
+            LOG_WARN("[ocr_session] (%ld,%ld,%ld,%ld) outside the session frame\n",
+                     long(r.left), long(r.top), long(r.right), long(r.bottom));
+            return "";
+        }
+        const cv::Rect box = field(r);
+        if (box.width <= 0 || box.height <= 0) return "";
+
+        const bool global = OcrSession::global(prof);
+        if (global && !mask(box)) {                     // on its own crop, exactly as read_region
+            std::string s = Engine::get().read_(wk, f_->img(box),
+                (r.bottom - r.top) < 60 ? tesseract::PSM_SINGLE_LINE : tesseract::PSM_SINGLE_BLOCK, prof);
+            return detail::record_ocr(r, std::move(s), wk.source);
+        }
 
-    return hits;
-}
+        if (prof && prof->glyph)
+            if (auto txt = GlyphAtlas::get().read(f_->img(box)))
+                return detail::record_ocr(r, *txt, dr::OcrSource::Glyph);
 
+        tesseract::PageSegMode psm = (r.bottom - r.top) < 60 ? tesseract::PSM_SINGLE_LINE
+                                                             : tesseract::PSM_SINGLE_BLOCK;
+        Engine::apply(wk, prof);
+        if (prof && prof->psm != tesseract::PSM_COUNT) psm = prof->psm;
 
-/*─────────────────────── find over entire window (unchanged API) ───────────*/
-inline std::vector<RECT> Engine::find(HWND hwnd,
-            std::string_view query,
-            double conf_thr)
-{
-    std::lock_guard<std::mutex> lock(mu_);
+        const Plane& p = global ? mask_ : plane(adaptive(prof));
+        if (p.img.empty()) return "";
+        const cv::Mat field = p.img(box);               // view, no copy
 
-    cv::Mat win = detail::capture(hwnd);
-    cv::Mat bw  = detail::binarise_wrap(win);
-    return scan(bw, RECT{0,0,0,0}, query, conf_thr, api_);
-}
+        if (CFG_BOOL("debug_img", false)) detail::save_debug_image(field, "ocr");
 
-/*─────────────────────── find inside a rectangle (NEW) ─────────────────────*/
-inline std::vector<RECT> Engine::find(HWND hwnd,
-            const RECT& roi,
-            std::string_view query,
-            double conf_thr)
-{
-    std::lock_guard<std::mutex> lock(mu_);
+        OcrCache& cache = OcrCache::get();
+        uint64_t key = 0;
+        if (cache.enabled()) {
+            key = detail::hash_mat(field, Engine::cache_salt(wk, psm, prof));
+            if (auto hit = cache.find(key)) return detail::record_ocr(r, *hit, dr::OcrSource::Tesseract);
+        }
+
+        tesseract::TessBaseAPI& api = wk.api;
+        if (wk.image != p.id) {                         // once per engine and plane
+            api.SetImage(p.img.data, p.img.cols, p.img.rows, 1, int(p.img.step));
+            wk.image = p.id;
+        }
+        auto old = api.GetPageSegMode();
+        api.SetPageSegMode(psm);
+        api.SetRectangle(box.x, box.y, box.width, box.height);
+        std::unique_ptr<char[]> txt(api.GetUTF8Text());
+        api.SetPageSegMode(old);
+
+        std::string s = txt ? txt.get() : "";
+        if (!s.empty() && (s.back() == '\n' || s.back() == '\r'))
+            s.pop_back();
+
+        if (cache.enabled()) cache.put(key, s);
+        return detail::record_ocr(r, s, dr::OcrSource::Tesseract);
+    }
+
+    FramePtr   f_;
+    Plane      gray_, adapt_, mask_;
+    std::map<std::array<int, 4>, bool> masked_;       // field → in mask_
+    std::mutex mu_;
+};
 
-    cv::Mat win = detail::capture(hwnd);
-    cv::Rect cvroi{roi.left, roi.top, roi.right - roi.left, roi.bottom - roi.top};
-    cv::Mat sub = win(cvroi).clone();               // crop
-    cv::Mat bw  = detail::binarise_wrap(sub);
+/*─────────────────────── batched multi-region OCR ──────────────────────────*/
+inline std::vector<std::string> Engine::read_regions(const FramePtr& f,
+                                                     const std::vector<RECT>& rois,
+                                                     const std::vector<std::string>& profiles)
+{
+    return OcrSession(f).read(rois, profiles);
+}
 
-    return scan(bw, roi, query, conf_thr, api_);
+inline std::vector<std::string> Engine::read_regions(HWND hwnd, const std::vector<RECT>& rois,
+                                                     const std::vector<std::string>& profiles)
+{
+    if (rois.empty()) return {};
+    /* one capture for every field: their bounding box */
+    RECT area = rois.front();
+    for (const RECT& r : rois) {
+        area.left  = std::min(area.left,  r.left);  area.top    = std::min(area.top,    r.top);
+        area.right = std::max(area.right, r.right); area.bottom = std::max(area.bottom, r.bottom);
+    }
+    return OcrSession(hwnd, area).read(rois, profiles);
 }
 
 
@@ -467,32 +2048,79 @@ inline std::string read_window(HWND hwnd, tesseract::PageSegMode psm)
 {
     return Engine::get().read(hwnd, psm);
 }
-inline std::string read_region(HWND hwnd, const RECT& r)
+inline std::string read_region(HWND hwnd, const RECT& r, const std::string& profile = "")
 {
-    return Engine::get().read(hwnd, r);
+    return Engine::get().read(hwnd, r, profile);
 }
 inline std::string read_window(HWND hwnd, const cv::Mat& prev, tesseract::PageSegMode psm)
 {
     return Engine::get().read(hwnd, prev, psm);
 }
-inline std::string read_region(HWND hwnd, const cv::Mat& prev, const RECT& r)
+inline std::string read_region(HWND hwnd, const cv::Mat& prev, const RECT& r,
+                               const std::string& profile = "")
+{
+    return Engine::get().read(hwnd, prev, r, profile);
+}
+inline std::vector<std::string> read_regions(HWND hwnd, const std::vector<RECT>& rois,
+                                             const std::vector<std::string>& profiles = {})
+{
+    return Engine::get().read_regions(hwnd, rois, profiles);
+}
+inline std::vector<std::string> read_regions(const FramePtr& f, const std::vector<RECT>& rois,
+                                             const std::vector<std::string>& profiles = {})
 {
-    return Engine::get().read(hwnd, prev, r);
+    return Engine::get().read_regions(f, rois, profiles);
+}
+/* build everything the first OCR would otherwise wait for: the engine
+   pool (traineddata), profiles, glyph atlas and the persisted OCR cache  */
+inline void warm_up()
+{
+    Engine::get();
+    if (OcrProfiles::get().any_glyph()) GlyphAtlas::get();   // else never loaded (nor warned about)
+    OcrCache::get();
+}
+/* frame-scoped OCR session over the current frame (or just `area`) */
+inline std::shared_ptr<OcrSession> ocr_session(HWND hwnd, const RECT& area = {})
+{
+    return area.right > area.left ? std::make_shared<OcrSession>(hwnd, area)
+                                  : std::make_shared<OcrSession>(hwnd);
 }
 /* full window */
 inline std::vector<RECT> locate_text(HWND hwnd,
     std::string_view q,
-    double conf = 60)
+    double conf = 60,
+    bool first_only = false)
 {
-    return Engine::get().find(hwnd, q, conf);
+    return Engine::get().find(hwnd, q, conf, first_only);
 }
 /* rectangle-limited search */
 inline std::vector<RECT> locate_text(HWND hwnd,
     const RECT& roi,
     std::string_view q,
-    double conf = 60)
+    double conf = 60,
+    bool first_only = false)
+{
+    return Engine::get().find(hwnd, roi, q, conf, first_only);
+}
+/* in a frame already at hand (roi {} = all of it) – no capture */
+inline std::vector<RECT> locate_text(const FramePtr& f,
+    const RECT& roi,
+    std::string_view q,
+    double conf = 60,
+    bool first_only = false)
 {
-    return Engine::get().find(hwnd, roi, q, conf);
+    auto hits = Engine::get().find_many(f, roi, { q }, conf, first_only);
+    auto it = hits.find(std::string(q));
+    return it == hits.end() ? std::vector<RECT>{} : std::move(it->second);
+}
+/* several phrases from one capture and one recognition pass */
+inline std::map<std::string, std::vector<RECT>> locate_many(HWND hwnd,
+    const RECT& roi,
+    const std::vector<std::string_view>& q,
+    double conf = 60,
+    bool first_only = false)
+{
+    return Engine::get().find_many(hwnd, roi, q, conf, first_only);
 }
 
 /* helper: always return 8-bit 1-channel grayscale */
@@ -505,10 +2133,168 @@ static inline cv::Mat to_gray(const cv::Mat& src)
     return g;
 }
 
+/*──────────────────────────────  change map  ───────────────────────────────
+ *  "Did this ROI change since frame Y?" without touching most pixels: both
+ *  frames carry a lazily built grid of 32x32 tile hashes; tiles fully inside
+ *  the ROI compare by hash, the partial strips along the ROI border compare
+ *  by memcmp. Only when something differs do callers go pixel-level.      */
+/* 64-bit hashes of the 32x32 tiles of a frame, on a grid anchored at the
+   client origin; only tiles lying fully inside the frame are hashed      */
+struct TileGrid {
+    static constexpr int T = 32;
+    int tx0 = 0, ty0 = 0;         // client tile coords of h[0]
+    int cols = 0, rows = 0;
+    std::vector<uint64_t> h;      // row-major, cols*rows
+    uint64_t at(int tx, int ty) const { return h[(ty - ty0) * cols + (tx - tx0)]; }
+};
+
+namespace detail {
+/* hash of one 32x32 BGRA tile (128 bytes per row); XXH3-style SSE2
+   accumulate over 8 lanes, scrambled per row so row order matters      */
+inline uint64_t tile_hash(const uint8_t* p, size_t stride)
+{
+#if defined(__SSE2__)
+    alignas(16) static const uint64_t key[16] = {
+        0xbe4ba423396cfeb8ull, 0x1cad21f72c81017cull, 0xdb979083e96dd4deull, 0x1f67b3b7a4a44072ull,
+        0x78e5c0cc4ee679cbull, 0x2172ffcc7dd05a82ull, 0x8e2443f7744608b8ull, 0x4c263a81e69035e0ull,
+        0xcb00c391bb52283cull, 0xa32e531b8b65d088ull, 0x4ef90da297486471ull, 0xd8acdea946ef1938ull,
+        0x3f349ce33f76faa8ull, 0x1d4f0bc7c7bbdcf9ull, 0x3159b4cd4be0518aull, 0x647378d9c97e9fc8ull };
+    const __m128i prime = _mm_set1_epi32(int(0x9E3779B1u));
+    __m128i kv[8], acc[8];
+    for (int k = 0; k < 8; ++k)
+        acc[k] = kv[k] = _mm_load_si128(reinterpret_cast<const __m128i*>(key) + k);
+
+    for (int y = 0; y < TileGrid::T; ++y, p += stride) {
+        for (int k = 0; k < 8; ++k) {
+            __m128i d    = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p) + k);
+            __m128i dk   = _mm_xor_si128(d, kv[(k + 3) & 7]);
+            __m128i prod = _mm_mul_epu32(dk, _mm_shuffle_epi32(dk, _MM_SHUFFLE(0, 3, 0, 1)));
+            acc[k] = _mm_add_epi64(acc[k], _mm_add_epi64(prod, _mm_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2))));
+            /* scramble: acc ^= acc >> 47; acc *= prime (lo/hi 32-bit halves) */
+            __m128i a  = _mm_xor_si128(acc[k], _mm_srli_epi64(acc[k], 47));
+            __m128i lo = _mm_mul_epu32(a, prime);
+            __m128i hi = _mm_mul_epu32(_mm_srli_epi64(a, 32), prime);
+            acc[k] = _mm_add_epi64(lo, _mm_slli_epi64(hi, 32));
+        }
+    }
+    alignas(16) uint64_t lanes[16];
+    for (int k = 0; k < 8; ++k) _mm_store_si128(reinterpret_cast<__m128i*>(lanes) + k, acc[k]);
+    uint64_t h = 0x27d4eb2f165667c5ull;
+    for (uint64_t v : lanes) { h ^= v; h *= 0x9fb21c651e98df25ull; h ^= h >> 29; }
+    return h;
+#else
+    uint64_t h = 0xcbf29ce484222325ull;                      // FNV-1a fallback
+    for (int y = 0; y < TileGrid::T; ++y, p += stride)
+        for (int x = 0; x < TileGrid::T * 4; ++x) { h ^= p[x]; h *= 0x100000001b3ull; }
+    return h;
+#endif
+}
+
+inline int floor_div(int a, int b) { return a >= 0 ? a / b : -((-a + b - 1) / b); }
+inline int ceil_div (int a, int b) { return -floor_div(-a, b); }
+
+/* pointer to client pixel (x,y) inside frame f (BGRA) */
+inline const uint8_t* px(const Frame& f, int x, int y)
+{
+    return f.img.ptr<uint8_t>(y - f.rc.top) + size_t(x - f.rc.left) * 4;
+}
+
+inline bool same_pixels(const Frame& a, const Frame& b, const cv::Rect& r)
+{
+    if (r.empty()) return true;
+    for (int y = r.y; y < r.y + r.height; ++y)
+        if (std::memcmp(px(a, r.x, y), px(b, r.x, y), size_t(r.width) * 4) != 0)
+            return false;
+    return true;
+}
+} // namespace detail
+
+/* tile hashes of f – computed on first use, then shared by every reader */
+inline std::shared_ptr<const TileGrid> tiles(const Frame& f)
+{
+    if (auto t = std::atomic_load(&f.tiles)) return t;
+
+    auto g = std::make_shared<TileGrid>();
+    const int T = TileGrid::T;
+    if (f.img.type() == CV_8UC4) {
+        g->tx0  = detail::ceil_div(f.rc.left, T);
+        g->ty0  = detail::ceil_div(f.rc.top,  T);
+        g->cols = std::max(0, detail::floor_div(f.rc.left + f.img.cols, T) - g->tx0);
+        g->rows = std::max(0, detail::floor_div(f.rc.top  + f.img.rows, T) - g->ty0);
+        g->h.resize(size_t(g->cols) * g->rows);
+        #pragma omp parallel for if (g->rows >= 8)
+        for (int r = 0; r < g->rows; ++r)
+            for (int c = 0; c < g->cols; ++c)
+                g->h[size_t(r) * g->cols + c] =
+                    detail::tile_hash(detail::px(f, (g->tx0 + c) * T, (g->ty0 + r) * T), f.img.step);
+    }
+    std::shared_ptr<const TileGrid> out = g;
+    std::atomic_store(&f.tiles, out);            // a racing reader may compute it twice – harmless
+    return out;
+}
+
+/* the changed parts of `roi` between two frames, as client rectangles:
+ * whole tiles whose hashes differ, plus border strips whose pixels differ.
+ * `first_only` stops at the first hit (enough for a yes/no question).
+ * A ROI not covered by both frames counts as changed in full.            */
+inline std::vector<RECT> changed_tiles(const Frame& since, const Frame& now,
+                                       const RECT& roi, bool first_only = false)
+{
+    const int T = TileGrid::T;
+    const cv::Rect want = detail::to_rect(roi);
+    const cv::Rect R = want & detail::to_rect(since.rc) & detail::to_rect(now.rc);
+    if (R != want || R.empty()
+        || since.img.type() != CV_8UC4 || now.img.type() != CV_8UC4)
+        return { roi };
+
+    std::vector<RECT> out;
+    auto hit = [&](const cv::Rect& r) { out.push_back(RECT{r.x, r.y, r.x + r.width, r.y + r.height}); };
+
+    /* tiles fully inside R */
+    const int tx0 = detail::ceil_div(R.x, T),  tx1 = detail::floor_div(R.x + R.width,  T);
+    const int ty0 = detail::ceil_div(R.y, T),  ty1 = detail::floor_div(R.y + R.height, T);
+    cv::Rect core;
+    if (tx1 > tx0 && ty1 > ty0) {
+        core = cv::Rect(tx0 * T, ty0 * T, (tx1 - tx0) * T, (ty1 - ty0) * T);
+        auto ga = tiles(since), gb = tiles(now);
+        for (int ty = ty0; ty < ty1; ++ty)
+            for (int tx = tx0; tx < tx1; ++tx)
+                if (ga->at(tx, ty) != gb->at(tx, ty)) {
+                    hit(cv::Rect(tx * T, ty * T, T, T));
+                    if (first_only) return out;
+                }
+    }
+
+    /* border strips (or all of R when no whole tile fits) */
+    std::vector<cv::Rect> strips;
+    if (core.empty()) {
+        strips.push_back(R);
+    } else {
+        strips.push_back(cv::Rect(R.x, R.y, R.width, core.y - R.y));                                   // top
+        strips.push_back(cv::Rect(R.x, core.y + core.height, R.width, R.y + R.height - core.y - core.height)); // bottom
+        strips.push_back(cv::Rect(R.x, core.y, core.x - R.x, core.height));                            // left
+        strips.push_back(cv::Rect(core.x + core.width, core.y, R.x + R.width - core.x - core.width, core.height)); // right
+    }
+    for (const cv::Rect& st : strips) {
+        if (st.width <= 0 || st.height <= 0) continue;
+        if (!detail::same_pixels(since, now, st)) {
+            hit(st);
+            if (first_only) return out;
+        }
+    }
+    return out;
+}
+
+inline bool roi_changed(const Frame& since, const Frame& now, const RECT& roi)
+{
+    return !changed_tiles(since, now, roi, true).empty();
+}
+
 /*──────────────── compare full window ───────────────*/
 inline double compare_imag(HWND hwnd, const cv::Mat& prev)
 {
-    cv::Mat cur = detail::capture(hwnd);
+    FramePtr f = frame(hwnd);
+    const cv::Mat& cur = f->img;
     if (prev.empty() || prev.size() != cur.size()) return 0.0;   // no basis
 
     cv::Mat a = to_gray(prev);
@@ -527,16 +2313,43 @@ inline double compare_imag(HWND hwnd,
                            const cv::Mat& prev,
                            const RECT& r)
 {
-    cv::Mat cur = detail::capture(hwnd);
-    if (prev.empty() || prev.size() != cur.size()) return 0.0;
-
     /* guard against bad RECT */
     if (r.right <= r.left || r.bottom <= r.top) return 0.0;
+    if (prev.empty()) return 0.0;
+
+    FramePtr f = frame(hwnd, r);                  // ROI pixels only
+    if (!f) return 0.0;
+    cv::Rect roi = detail::to_rect(f->rc);
+    if ((roi & cv::Rect(0, 0, prev.cols, prev.rows)) != roi || roi.empty()) return 0.0;
+
+    cv::Mat a = to_gray(prev(roi));
+    cv::Mat b = to_gray(f->img);
+
+    cv::Mat diff;  cv::absdiff(a, b, diff);
+    double sumDiff = cv::sum(diff)[0];
+    double maxDiff = 255.0 * diff.total();
+    double similarity = 1.0 - (sumDiff / maxDiff);
+    return std::clamp(similarity, 0.0, 1.0);
+}
+/*──────────── compare a rectangle against a captured frame ──────────*/
+/* tile-hash check first; pixel similarity only if something changed   */
+inline double compare_imag(HWND hwnd, const FramePtr& prev, const RECT& r)
+{
+    if (!prev || r.right <= r.left || r.bottom <= r.top) return 0.0;
 
-    cv::Rect roi{r.left, r.top, r.right - r.left, r.bottom - r.top};
+    FramePtr f = frame(hwnd, r);
+    if (!f) return 0.0;
+    cv::Rect roi = detail::to_rect(f->rc);
+    if (roi.empty() || (roi & detail::to_rect(prev->rc)) != roi) return 0.0;
+
+    if (!roi_changed(*prev, *f, f->rc)) {
+        LOG_DEBUG("[compare_imag] roi (%ld,%ld,%ld,%ld) unchanged by tile hash\n",
+                  r.left, r.top, r.right, r.bottom);
+        return 1.0;
+    }
 
-    cv::Mat a = to_gray(prev)(roi);
-    cv::Mat b = to_gray(cur )(roi);
+    cv::Mat a = to_gray(prev->img(roi - cv::Point(prev->rc.left, prev->rc.top)));
+    cv::Mat b = to_gray(f->img);
 
     cv::Mat diff;  cv::absdiff(a, b, diff);
     double sumDiff = cv::sum(diff)[0];
@@ -0,0 +1,290 @@
+// dsink.hpp
+#pragma once
+/*  Results sink – `save` appends one compact JSON object per line to a
+ *  single file per run and output folder, instead of one small file per
+ *  item:
+ *
+ *      <folder>/results_<YYYYmmdd_HHMMSS>.jsonl       {"_id":"…","name":"…",…}\n
+ *      <folder>/results_<YYYYmmdd_HHMMSS>.jsonl.idx   IndexEntry per record
+ *
+ *  Callers only format the line. A writer thread appends whole batches and
+ *  fflush()es each one: once a batch is written, a crash of this process no
+ *  longer loses it. Records still queued for the writer (normally well under
+ *  sink_sync_ms worth) are lost on a hard crash – access violation, kill –
+ *  and only drained when the exit goes through close_all() or
+ *  std::terminate. fsync runs at most every sink_sync_ms (the power-loss
+ *  window).
+ *  An index entry is written after its line, so the index never points past
+ *  the data; a torn last line (killed mid-write) fails its CRC / JSON parse
+ *  and readers skip it.
+ *
+ *  Portable: no windows.h / OpenCV.
+ */
+#include <zlib.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <exception>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "dlog.hpp"
+
+#ifdef _WIN32
+  #include <io.h>
+#else
+  #include <unistd.h>
+#endif
+
+namespace ds {
+
+#pragma pack(push, 1)
+struct IndexEntry {
+    uint64_t offset;     // first byte of the line
+    uint32_t size;       // without the '\n'
+    uint32_t crc;        // crc32 of the line
+};
+#pragma pack(pop)
+
+namespace detail {
+inline void sync(std::FILE* f)
+{
+#ifdef _WIN32
+    ::_commit(::_fileno(f));
+#else
+    ::fsync(::fileno(f));
+#endif
+}
+
+/* 64-bit seek / tell – long is 32 bits on Win64 */
+inline int seek(std::FILE* f, uint64_t off, int whence)
+{
+#ifdef _WIN32
+    return ::_fseeki64(f, int64_t(off), whence);
+#else
+    return ::fseeko(f, off_t(off), whence);
+#endif
+}
+
+inline uint64_t tell(std::FILE* f)
+{
+#ifdef _WIN32
+    return uint64_t(::_ftelli64(f));
+#else
+    return uint64_t(::ftello(f));
+#endif
+}
+} // namespace detail
+
+/*────────────────────────────────  writer  ─────────────────────────────────*/
+class Sink {
+public:
+    Sink(const std::string& path, int sync_ms)
+        : path_(path), sync_(std::chrono::milliseconds(sync_ms > 0 ? sync_ms : 1))
+    {
+        data_ = std::fopen(path.c_str(), "ab");
+        idx_  = std::fopen((path + ".idx").c_str(), "ab");
+        if (!data_ || !idx_) {
+            LOG_ERROR("[sink] cannot open %s\n", path.c_str());
+            return;
+        }
+        detail::seek(data_, 0, SEEK_END);         // "ab" may report 0 until the first write
+        off_ = detail::tell(data_);
+        last_sync_ = std::chrono::steady_clock::now();
+        th_ = std::thread([this] { run(); });
+        LOG_INFO("[sink] writing results to %s\n", path.c_str());
+    }
+
+    ~Sink() { close(); }
+    Sink(const Sink&) = delete;
+    Sink& operator=(const Sink&) = delete;
+
+    explicit operator bool() const { return data_ && idx_; }
+    const std::string& path() const { return path_; }
+
+    /* one record, without the trailing newline – returns at once */
+    void append(std::string line)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            if (stop_ || !data_) return;
+            pending_.push_back(std::move(line));
+            ++queued_;
+        }
+        cv_.notify_one();
+    }
+
+    /* block until every record appended so far is on disk (fsynced) */
+    void flush()
+    {
+        std::unique_lock<std::mutex> lock(mu_);
+        if (!th_.joinable()) return;
+        const uint64_t target = queued_;
+        force_sync_ = true;
+        cv_.notify_one();
+        done_.wait(lock, [&] { return synced_ >= target || !th_.joinable(); });
+    }
+
+    /* drain, sync, stop the writer */
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            if (stop_) return;
+            stop_ = true;
+        }
+        cv_.notify_one();
+        if (th_.joinable()) {
+            if (th_.get_id() == std::this_thread::get_id()) {   // terminate on the writer itself
+                th_.detach();
+                return;
+            }
+            th_.join();
+        }
+        if (data_) std::fclose(data_);
+        if (idx_)  std::fclose(idx_);
+        data_ = idx_ = nullptr;
+        LOG_INFO("[sink] %s closed: %llu record(s)\n", path_.c_str(), (unsigned long long)synced_);
+    }
+
+private:
+    void run()
+    {
+        std::vector<std::string> batch;
+        std::vector<IndexEntry>  entries;
+        std::unique_lock<std::mutex> lock(mu_);
+        while (true) {
+            cv_.wait_for(lock, sync_, [&] { return !pending_.empty() || stop_ || force_sync_; });
+            batch.swap(pending_);
+            const bool stopping = stop_;
+            bool       must_sync = force_sync_ || stopping;
+            force_sync_ = false;
+            lock.unlock();
+
+            entries.clear();
+            for (const std::string& l : batch) {
+                entries.push_back({ off_, uint32_t(l.size()),
+                                    uint32_t(crc32(0L, reinterpret_cast<const Bytef*>(l.data()), uInt(l.size()))) });
+                std::fwrite(l.data(), 1, l.size(), data_);
+                std::fputc('\n', data_);
+                off_ += l.size() + 1;
+            }
+            if (!batch.empty()) {
+                std::fflush(data_);                // data before the index that points at it
+                std::fwrite(entries.data(), sizeof(IndexEntry), entries.size(), idx_);
+                std::fflush(idx_);
+            }
+            const auto now = std::chrono::steady_clock::now();
+            must_sync = must_sync || (written_ + batch.size() > synced_ && now - last_sync_ >= sync_);
+            if (must_sync) {
+                detail::sync(data_);
+                detail::sync(idx_);
+                last_sync_ = now;
+            }
+
+            lock.lock();
+            written_ += batch.size();
+            if (must_sync) synced_ = written_;
+            batch.clear();
+            done_.notify_all();
+            if (stopping && pending_.empty()) break;
+        }
+    }
+
+    std::string                            path_;
+    std::chrono::milliseconds              sync_;
+    std::FILE*                             data_ = nullptr;
+    std::FILE*                             idx_  = nullptr;
+    uint64_t                               off_  = 0;          // writer thread only
+    std::chrono::steady_clock::time_point  last_sync_;         // writer thread only
+
+    std::mutex                             mu_;
+    std::condition_variable                cv_, done_;
+    std::vector<std::string>               pending_;
+    uint64_t                               queued_ = 0, written_ = 0, synced_ = 0;
+    bool                                   stop_ = false, force_sync_ = false;
+    std::thread                            th_;
+};
+
+/*──────────────────────────────  per folder  ───────────────────────────────*/
+/* one sink per output folder, opened by the first save into it and closed
+   at exit – or from std::terminate when a proc throws past main          */
+class Sinks {
+public:
+    static Sinks& get()
+    {
+        static Sinks s; return s;
+    }
+
+    /* nullptr when the file cannot be created */
+    Sink* folder(const std::string& dir, int sync_ms = 1000)
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto& s = map_[dir];
+        if (!s) {
+            std::error_code ec;
+            std::filesystem::create_directories(dir, ec);
+            char name[64];
+            std::time_t now = std::time(nullptr);
+            std::strftime(name, sizeof name, "results_%Y%m%d_%H%M%S.jsonl", std::localtime(&now));
+            s = std::make_unique<Sink>((std::filesystem::path(dir) / name).string(), sync_ms);
+            if (!*s) { map_.erase(dir); return nullptr; }
+        }
+        return s.get();
+    }
+
+    void close_all()
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        for (auto& [dir, s] : map_) s->close();
+        map_.clear();
+    }
+
+private:
+    Sinks()
+    {
+        static std::terminate_handler prev = std::set_terminate([] {
+            Sinks::get().close_on_terminate();
+            if (prev) prev(); else std::abort();
+        });
+    }
+
+    /* terminate may fire while folder() holds mu_ – never wait for it */
+    void close_on_terminate()
+    {
+        std::unique_lock<std::mutex> lock(mu_, std::try_to_lock);
+        if (!lock) return;
+        for (auto& [dir, s] : map_) s->close();
+    }
+    ~Sinks() { close_all(); }
+
+    std::map<std::string, std::unique_ptr<Sink>> map_;
+    std::mutex                                   mu_;
+};
+
+/*─────────────────────────────  random access  ─────────────────────────────*/
+/* record n of a .jsonl through its .idx; nullopt when out of range or torn */
+inline std::optional<std::string> record(const std::string& path, uint64_t n)
+{
+    std::unique_ptr<std::FILE, int(*)(std::FILE*)> idx(std::fopen((path + ".idx").c_str(), "rb"), &std::fclose);
+    std::unique_ptr<std::FILE, int(*)(std::FILE*)> dat(std::fopen(path.c_str(), "rb"), &std::fclose);
+    if (!idx || !dat) return std::nullopt;
+
+    IndexEntry e{};
+    if (detail::seek(idx.get(), n * sizeof e, SEEK_SET) != 0
+        || std::fread(&e, sizeof e, 1, idx.get()) != 1) return std::nullopt;
+    std::string line(e.size, '\0');
+    if (detail::seek(dat.get(), e.offset, SEEK_SET) != 0
+        || std::fread(line.data(), 1, line.size(), dat.get()) != line.size()) return std::nullopt;
+    if (crc32(0L, reinterpret_cast<const Bytef*>(line.data()), uInt(line.size())) != e.crc) return std::nullopt;
+    return line;
+}
+
+} // namespace ds
@@ -0,0 +1,142 @@
+// dtemplate.hpp
+#pragma once
+/*  Fixed-art widget finder (buttons, tabs, icons).
+ *
+ *  PNG crops under template_dir are loaded once; the name of a template is
+ *  its path below that folder without extension ("buttons/ok"). Matching is
+ *  coarse-to-fine normalised cross-correlation (TM_CCOEFF_NORMED):
+ *
+ *      gray ROI ─► pyramid ─► full search at the coarsest level
+ *               ─► ±2 px refinement at every finer level ─► score at 1:1
+ *
+ *  Used by click_template / wait_template and the find_template intrinsic.
+ */
+#include "dconfig.hpp"
+#include "dlog.hpp"
+#include "dscreen_ocr.hpp"   // so::frame / FramePtr
+#include <opencv2/imgproc.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace so {
+
+struct TemplateHit {
+    RECT   box;          // client coords
+    double score = 0;    // TM_CCOEFF_NORMED at full resolution
+};
+
+class Templates {
+public:
+    static Templates& get()
+    {
+        static Templates t; return t;
+    }
+
+    bool has(const std::string& name) const { return map_.count(name) != 0; }
+
+    /* best match of `name` inside frame f (roi {} = whole frame) */
+    std::optional<TemplateHit> find(const FramePtr& f, const std::string& name,
+                                    const RECT& roi = {}) const
+    {
+        auto it = map_.find(name);
+        if (it == map_.end()) {
+            LOG_WARN("[template] unknown template '%s'\n", name.c_str());
+            return std::nullopt;
+        }
+        const std::vector<cv::Mat>& tpl = it->second;
+
+        FramePtr c = roi.right > roi.left ? detail::crop(f, roi) : f;
+        if (!c || c->img.cols < tpl[0].cols || c->img.rows < tpl[0].rows) return std::nullopt;
+
+        /* search pyramid, as deep as the template's */
+        std::vector<cv::Mat> img(1);
+        if (c->img.channels() == 1) img[0] = c->img;
+        else cv::cvtColor(c->img, img[0], c->img.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+        while (img.size() < tpl.size()
+               && img.back().cols / 2 >= tpl[img.size()].cols && img.back().rows / 2 >= tpl[img.size()].rows) {
+            cv::Mat d; cv::pyrDown(img.back(), d); img.push_back(d);
+        }
+
+        /* coarsest level: everywhere */
+        int l = int(img.size()) - 1;
+        cv::Mat res; double best = 0; cv::Point loc;
+        cv::matchTemplate(img[l], tpl[l], res, cv::TM_CCOEFF_NORMED);
+        cv::minMaxLoc(res, nullptr, &best, nullptr, &loc);
+        if (best < min_score_ - coarse_slack_) {
+            LOG_DEBUG("[template] %s: coarse score %.3f – absent\n", name.c_str(), best);
+            return std::nullopt;
+        }
+
+        /* finer levels: a few pixels around the upscaled position */
+        for (--l; l >= 0; --l) {
+            const cv::Rect win = cv::Rect(loc.x * 2 - 2, loc.y * 2 - 2, tpl[l].cols + 4, tpl[l].rows + 4)
+                               & cv::Rect(0, 0, img[l].cols, img[l].rows);
+            if (win.width < tpl[l].cols || win.height < tpl[l].rows) return std::nullopt;
+            cv::Point p;
+            cv::matchTemplate(img[l](win), tpl[l], res, cv::TM_CCOEFF_NORMED);
+            cv::minMaxLoc(res, nullptr, &best, nullptr, &p);
+            loc = win.tl() + p;
+        }
+
+        LOG_DEBUG("[template] %s: score %.3f at (%d,%d)\n", name.c_str(), best,
+                  loc.x + int(c->rc.left), loc.y + int(c->rc.top));
+        if (best < min_score_) return std::nullopt;
+
+        const LONG x = c->rc.left + loc.x, y = c->rc.top + loc.y;
+        return TemplateHit{ RECT{ x, y, x + tpl[0].cols, y + tpl[0].rows }, best };
+    }
+
+    std::optional<TemplateHit> find(HWND hwnd, const std::string& name, const RECT& roi = {}) const
+    {
+        return find(roi.right > roi.left ? frame(hwnd, roi) : frame(hwnd), name);
+    }
+
+private:
+    Templates()
+        : min_score_(CFG_DBL("template_min_score", 0.85)),
+          coarse_slack_(CFG_DBL("template_coarse_slack", 0.15))
+    {
+        namespace fs = std::filesystem;
+        const fs::path dir    = CFG_STR("template_dir", "./resources/templates");
+        const int      levels = std::max(1, CFG_INT("template_levels", 3));
+        std::error_code ec;
+        if (!fs::is_directory(dir, ec)) {
+            LOG_DEBUG("[template] no template folder %s\n", dir.string().c_str());
+            return;
+        }
+        for (const auto& e : fs::recursive_directory_iterator(dir, ec)) {
+            if (e.path().extension() != ".png") continue;
+            cv::Mat m = cv::imread(e.path().string(), cv::IMREAD_UNCHANGED);
+            if (m.empty()) { LOG_WARN("[template] cannot read %s\n", e.path().string().c_str()); continue; }
+
+            std::vector<cv::Mat> pyr(1);
+            if (m.channels() == 1) pyr[0] = m;
+            else cv::cvtColor(m, pyr[0], m.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+            /* stop while the template still has some structure (≥ 12 px) */
+            while (int(pyr.size()) < levels && pyr.back().cols >= 24 && pyr.back().rows >= 24) {
+                cv::Mat d; cv::pyrDown(pyr.back(), d); pyr.push_back(d);
+            }
+
+            std::string name = fs::relative(e.path(), dir, ec).replace_extension().generic_string();
+            map_[name] = std::move(pyr);
+        }
+        LOG_INFO("[template] %zu template(s) from %s\n", map_.size(), dir.string().c_str());
+    }
+
+    std::map<std::string, std::vector<cv::Mat>> map_;   // name → gray pyramid (level 0 = 1:1)
+    double min_score_;
+    double coarse_slack_;
+};
+
+/* facade */
+inline std::optional<TemplateHit> locate_template(HWND hwnd, const std::string& name,
+                                                  const RECT& roi = {})
+{
+    return Templates::get().find(hwnd, name, roi);
+}
+
+} // namespace so
@@ -0,0 +1,146 @@
+// dtessdata.hpp
+#pragma once
+/*  Tesseract language models from memory.
+ *
+ *  Built with EMBED_TESSDATA=1 (see makefile) the .traineddata files are
+ *  linked into the executable with .incbin – one read-only copy in the
+ *  image, no file I/O when the engines start:
+ *
+ *      -DTESSDATA_EMBED='X(spa) X(eng)'  -DTESSDATA_DIR='"./resources/languages"'
+ *
+ *  Without it, reader() still loads each model from languages_path once
+ *  and serves every engine of the pool from that buffer.
+ *
+ *  Engine::init passes reader() to TessBaseAPI::Init (FileReader overload).
+ */
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "dlog.hpp"
+
+/*──────────────────────────────  embedded blobs  ───────────────────────────*/
+#ifdef TESSDATA_EMBED
+#ifndef TESSDATA_DIR
+#define TESSDATA_DIR "./resources/languages"
+#endif
+#ifdef _WIN32
+#define TESSDATA_SECTION ".section .rdata,\"dr\"\n"
+#else
+#define TESSDATA_SECTION ".section .rodata\n"
+#endif
+/* tessdata_<lang> … tessdata_<lang>_end, paths relative to the build dir */
+#define X(lang)                                                     \
+    TESSDATA_SECTION                                                \
+    ".balign 64\n"                                                  \
+    ".globl tessdata_" #lang "\n"                                   \
+    "tessdata_" #lang ":\n"                                         \
+    ".incbin \"" TESSDATA_DIR "/" #lang ".traineddata\"\n"          \
+    ".globl tessdata_" #lang "_end\n"                               \
+    "tessdata_" #lang "_end:\n"                                     \
+    ".byte 0\n"                                                     \
+    ".text\n"
+__asm__(TESSDATA_EMBED);
+#undef X
+
+#define X(lang) extern "C" const char tessdata_##lang[], tessdata_##lang##_end[];
+TESSDATA_EMBED
+#undef X
+#endif
+
+namespace so {
+namespace tessdata {
+
+struct Blob {
+    const char* data;
+    size_t      size;
+};
+
+/* models linked into the binary, by language code */
+inline const std::map<std::string, Blob, std::less<>>& embedded()
+{
+    static const std::map<std::string, Blob, std::less<>> m = {
+#ifdef TESSDATA_EMBED
+#define X(lang) { #lang, { tessdata_##lang, size_t(tessdata_##lang##_end - tessdata_##lang) } },
+        TESSDATA_EMBED
+#undef X
+#endif
+    };
+    return m;
+}
+
+/* true when every language of "spa+eng" is linked in */
+inline bool embedded(std::string_view langs)
+{
+    const auto& m = embedded();
+    while (!langs.empty()) {
+        size_t p = langs.find('+');
+        if (m.find(langs.substr(0, p)) == m.end()) return false;
+        if (p == std::string_view::npos) break;
+        langs.remove_prefix(p + 1);
+    }
+    return true;
+}
+
+namespace detail {
+/* files read from disk once, shared by every engine */
+inline std::map<std::string, std::shared_ptr<const std::vector<char>>>& files()
+{
+    static std::map<std::string, std::shared_ptr<const std::vector<char>>> f;
+    return f;
+}
+inline std::mutex& files_mu()
+{
+    static std::mutex mu; return mu;
+}
+} // namespace detail
+
+/* tesseract::FileReader – "<dir>/<lang>.traineddata" from the embedded
+   blob when there is one, otherwise from disk through a shared buffer   */
+inline bool reader(const char* filename, std::vector<char>* out)
+{
+    std::string_view name(filename);
+    std::string_view base = name.substr(name.find_last_of("/\\") + 1);   // npos + 1 = 0
+    std::string_view lang = base.substr(0, base.find('.'));
+
+    if (auto it = embedded().find(lang); it != embedded().end()
+        && base.substr(lang.size()) == ".traineddata") {
+        out->assign(it->second.data, it->second.data + it->second.size);
+        LOG_DEBUG("[tessdata] %s: embedded, %zu bytes\n", filename, it->second.size);
+        return true;
+    }
+
+    std::shared_ptr<const std::vector<char>> buf;
+    {
+        std::lock_guard<std::mutex> lock(detail::files_mu());
+        auto& f = detail::files()[filename];
+        if (!f) {
+            std::ifstream in(filename, std::ios::binary);
+            if (!in) {
+                LOG_ERROR("[tessdata] cannot read %s\n", filename);
+                return false;
+            }
+            f = std::make_shared<const std::vector<char>>(std::istreambuf_iterator<char>(in),
+                                                          std::istreambuf_iterator<char>());
+            LOG_DEBUG("[tessdata] %s: loaded from disk, %zu bytes\n", filename, f->size());
+        }
+        buf = f;
+    }
+    out->assign(buf->begin(), buf->end());
+    return true;
+}
+
+/* drop the disk buffers once every engine is initialised */
+inline void release_files()
+{
+    std::lock_guard<std::mutex> lock(detail::files_mu());
+    detail::files().clear();
+}
+
+} // namespace tessdata
+} // namespace so
@@ -18,6 +18,9 @@
 #include <sstream>
 #include <iomanip>
 #include <limits>
+#include <optional>
+#include <string_view>
+#include <cstdlib>
 #include "dlog.hpp"
 
 #ifdef _OPENMP
@@ -99,6 +102,52 @@ double extract_decimal(const std::basic_string<CharT,Traits,Alloc>& s)
     }
 }
 
+/* locale-aware variant – the first number in s, written with `decimal` as
+   decimal mark and `group` (or a space) between thousands:
+       "14.995 kamas/u."  ('.' group, ',' decimal)  → 14995
+       "1,5"                                          → 1.5
+   A separator only counts as grouping when exactly three digits follow.  */
+inline std::optional<double> parse_decimal(std::string_view s, char decimal, char group)
+{
+    size_t p = 0;
+    while (p < s.size() && !::isdigit(static_cast<unsigned char>(s[p]))) ++p;
+    if (p == s.size()) return std::nullopt;
+    const bool neg = p > 0 && s[p - 1] == '-';
+
+    auto digits_at = [&](size_t q, size_t n) {
+        for (size_t k = 0; k < n; ++k)
+            if (q + k >= s.size() || !::isdigit(static_cast<unsigned char>(s[q + k]))) return false;
+        return q + n >= s.size() || !::isdigit(static_cast<unsigned char>(s[q + n]));
+    };
+
+    std::string num;
+    bool dot = false;
+    for (; p < s.size(); ++p) {
+        const char c = s[p];
+        if (::isdigit(static_cast<unsigned char>(c))) num.push_back(c);
+        else if (!dot && (c == group || c == ' ') && c != decimal && digits_at(p + 1, 3)) continue;
+        else if (!dot && c == decimal && p + 1 < s.size() && ::isdigit(static_cast<unsigned char>(s[p + 1]))) {
+            num.push_back('.'); dot = true;
+        }
+        else break;
+    }
+    const double v = std::strtod(num.c_str(), nullptr);
+    return neg ? -v : v;
+}
+
+inline double extract_decimal(std::string_view s, char decimal, char group)
+{
+    return parse_decimal(s, decimal, group).value_or(0.0);
+}
+
+/* number_decimal / number_group from .config (game client language) */
+inline std::optional<double> parse_decimal(std::string_view s)
+{
+    static const char decimal = CFG_STR("number_decimal", ",").c_str()[0];
+    static const char group   = CFG_STR("number_group", ".").c_str()[0];
+    return parse_decimal(s, decimal, group);
+}
+
 template <class Str>
 Str remove_line_breaks(Str s)
 {
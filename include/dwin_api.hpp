@@ -10,9 +10,11 @@
 #include <fstream>
 #include <mutex>
 #include <memory>
+#include <map>
 #include <shellscalingapi.h> // link to Shcore.lib
 #include "dlog.hpp"      /* LOG_*    */
 #include <thread>
+#include <atomic>
 
 namespace dw {
 
@@ -66,10 +68,17 @@ inline std::string get_window_title(HWND h){wchar_t buf[256]{};::GetWindowTextW(
 inline double inv_scale(){static double v=1.0/CFG_DBL("screen_dpi_scale",1.0);return v;}
 inline void   adjust_dpi(int&x,int&y){x=int(x*inv_scale());y=int(y*inv_scale());}
 
+/*──────────────────────── input sequence ───────────────────────────────────*/
+/* bumped by every mouse / keyboard event we post, so captured frames can tell
+   whether they were taken before or after the last input                    */
+inline std::atomic<uint64_t>& input_counter(){static std::atomic<uint64_t> n{0};return n;}
+inline uint64_t input_seq(){return input_counter().load(std::memory_order_acquire);}
+inline void     note_input(){input_counter().fetch_add(1,std::memory_order_acq_rel);}
+
 /*──────────────────── mouse / keyboard helpers ───────────────────────────*/
-inline void mouse_down(HWND h, int x, int y){dw::adjust_dpi(x, y);LPARAM lp = MAKELPARAM(x, y);::PostMessage(h, WM_LBUTTONDOWN, MK_LBUTTON, lp);}
-inline void mouse_up(HWND h, int x, int y){dw::adjust_dpi(x, y);LPARAM lp = MAKELPARAM(x, y);::PostMessage(h, WM_LBUTTONUP, 0, lp);}
-inline void click(HWND h,int x,int y){adjust_dpi(x,y);LPARAM lp=MAKELPARAM(x,y);::PostMessage(h,WM_LBUTTONDOWN,MK_LBUTTON,lp);::PostMessage(h,WM_LBUTTONUP,0,lp);}
+inline void mouse_down(HWND h, int x, int y){note_input();dw::adjust_dpi(x, y);LPARAM lp = MAKELPARAM(x, y);::PostMessage(h, WM_LBUTTONDOWN, MK_LBUTTON, lp);}
+inline void mouse_up(HWND h, int x, int y){note_input();dw::adjust_dpi(x, y);LPARAM lp = MAKELPARAM(x, y);::PostMessage(h, WM_LBUTTONUP, 0, lp);}
+inline void click(HWND h,int x,int y){note_input();adjust_dpi(x,y);LPARAM lp=MAKELPARAM(x,y);::PostMessage(h,WM_LBUTTONDOWN,MK_LBUTTON,lp);::PostMessage(h,WM_LBUTTONUP,0,lp);}
 inline void dbl_click(HWND h,int x,int y){click(h,x,y);::Sleep(60);click(h,x,y);}
 inline void move_cursor_in_focus(HWND h,int x,int y) {
     // 1) remember who was in front
@@ -93,6 +102,7 @@ inline void move_cursor_in_focus(HWND h,int x,int y) {
     std::this_thread::sleep_for(std::chrono::milliseconds(5));
     
     // do the actual move
+    note_input();
     adjust_dpi(x,y);
     POINT p{x,y};
     ::ClientToScreen(h,&p);
@@ -107,10 +117,10 @@ inline void move_cursor_in_focus(HWND h,int x,int y) {
     ::AttachThreadInput(thisT, targetT, FALSE);
     ::AttachThreadInput(thisT, prevT,   FALSE);
 }
-inline void move_cursor(HWND h, int x, int y){adjust_dpi(x, y);LPARAM lp = MAKELPARAM(x, y);::PostMessage(h, WM_MOUSEMOVE, 0, lp);}
-inline void send_key(HWND h,WORD vk,bool ctrl=false){if(ctrl)::PostMessage(h,WM_KEYDOWN,VK_CONTROL,0);::PostMessage(h,WM_KEYDOWN,vk,0);::PostMessage(h,WM_KEYUP,vk,0);if(ctrl)::PostMessage(h,WM_KEYUP,VK_CONTROL,0);} 
-inline void send_text(HWND h,std::string_view s,int d=35){for(char c:s){::PostMessage(h,WM_CHAR,(WPARAM)(unsigned char)c,0);::Sleep(d);} }
-inline void send_text(HWND h,std::wstring_view s,int d=35){for(wchar_t c:s){::PostMessage(h,WM_CHAR,(WPARAM)c,0);::Sleep(d);} }
+inline void move_cursor(HWND h, int x, int y){note_input();adjust_dpi(x, y);LPARAM lp = MAKELPARAM(x, y);::PostMessage(h, WM_MOUSEMOVE, 0, lp);}
+inline void send_key(HWND h,WORD vk,bool ctrl=false){note_input();if(ctrl)::PostMessage(h,WM_KEYDOWN,VK_CONTROL,0);::PostMessage(h,WM_KEYDOWN,vk,0);::PostMessage(h,WM_KEYUP,vk,0);if(ctrl)::PostMessage(h,WM_KEYUP,VK_CONTROL,0);} 
+inline void send_text(HWND h,std::string_view s,int d=35){note_input();for(char c:s){::PostMessage(h,WM_CHAR,(WPARAM)(unsigned char)c,0);::Sleep(d);} }
+inline void send_text(HWND h,std::wstring_view s,int d=35){note_input();for(wchar_t c:s){::PostMessage(h,WM_CHAR,(WPARAM)c,0);::Sleep(d);} }
 inline void send_vk(HWND hwnd, std::string_view key) {
     bool ctrl = false;
     WORD vk = 0;
@@ -178,6 +188,7 @@ inline void send_vk_infocus(HWND hwnd, std::string_view key) {
 inline void mouse_wheel(HWND hwnd, int x, int y, int delta)
 {
     LOG_WARN("mouse_wheel does not seem to work ... \n");
+    note_input();
     dw::adjust_dpi(x, y);
 
     /* move the real mouse pointer */
@@ -205,45 +216,183 @@ inline bool save_bitmap(const uint8_t* data,size_t stride,int w,int h,const std:
     bih.biSize=sizeof(BITMAPINFOHEADER); bih.biWidth=w; bih.biHeight=-h; bih.biPlanes=1; bih.biBitCount=32; bih.biCompression=BI_RGB;
     size_t img=w*h*4; bfh.bfType=0x4D42; bfh.bfOffBits=sizeof(bfh)+sizeof(bih); bfh.bfSize=DWORD(bfh.bfOffBits+img);
     FILE* fp=_wfopen(file.wstring().c_str(),L"wb"); if(!fp){LOG_ERROR("save_bitmap: %s",last_error().c_str());return false;}
-    fwrite(&bfh,sizeof(bfh),1,fp); fwrite(&bih,sizeof(bih),1,fp); fwrite(data,img,1,fp); fclose(fp); return true;
+    fwrite(&bfh,sizeof(bfh),1,fp); fwrite(&bih,sizeof(bih),1,fp);
+    for(int y=0;y<h;++y) fwrite(data+y*stride,size_t(w)*4,1,fp);
+    fclose(fp); return true;
 }
 } // namespace detail
 
-/*──────────────────────────── PrintWindow capture ──────────────────────────*/
-inline bool capture_window(HWND hwnd,const std::filesystem::path& file)
-{
-    if(!::IsWindow(hwnd)){LOG_ERROR("capture_window: invalid HWND\n");return false;}
-    if(::IsIconic(hwnd)) ::ShowWindow(hwnd,SW_RESTORE);
-
-    RECT rc{}; ::GetClientRect(hwnd,&rc);
-    int w=rc.right, h=rc.bottom; if(w<=0||h<=0){LOG_ERROR("capture_window: zero-sized client\n");return false;}
+/*──────────────────────── persistent capture context ───────────────────────
+ *  Keeps one memory DC and a small ring of top-down 32-bit DIB sections per
+ *  HWND. PrintWindow renders straight into the section, so the pixels are
+ *  readable in place – no per-call DC/bitmap churn and no GetDIBits copy.
+ *  A slot is only reused once every Capture leasing it has been dropped;
+ *  full-frame slots are rebuilt only when the client area is resized.      */
+struct Capture {
+    const uint8_t* bits{};                  // top-down BGRA
+    int            w{}, h{};
+    size_t         stride{};                // bytes per row
+    std::shared_ptr<const void> lease;      // slot stays ours while held
+    explicit operator bool() const { return bits != nullptr; }
+};
+
+class CaptureContext {
+public:
+    CaptureContext(HWND hwnd, size_t ring) : hwnd_(hwnd), max_(std::max<size_t>(ring, 1))
+    {
+        mem_ = ::CreateCompatibleDC(nullptr);
+    }
+    ~CaptureContext() { full_.slots.clear(); strip_.slots.clear(); if (mem_) ::DeleteDC(mem_); }
+    CaptureContext(const CaptureContext&) = delete;
+    CaptureContext& operator=(const CaptureContext&) = delete;
+
+    /* whole client area */
+    Capture grab()
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        RECT rc{}; ::GetClientRect(hwnd_, &rc);
+        int w = rc.right, h = rc.bottom;
+        if (w <= 0 || h <= 0) { LOG_ERROR("capture: zero-sized client\n"); return {}; }
+
+        auto slot = acquire(full_, w, h, true);
+        if (!slot) return {};
+
+        HGDIOBJ old = ::SelectObject(mem_, slot->bmp);
+        if (!::PrintWindow(hwnd_, mem_, PW_CLIENTONLY)) {  // UAC, OpenGL, … – fallback:
+            LOG_WARN("PrintWindow failed (%s), falling back to BitBlt\n", last_error().c_str());
+            POINT p{0, 0}; ::ClientToScreen(hwnd_, &p);
+            HDC scr = ::GetDC(nullptr);
+            ::BitBlt(mem_, 0, 0, w, h, scr, p.x, p.y, SRCCOPY | CAPTUREBLT);
+            ::ReleaseDC(nullptr, scr);
+        }
+        ::GdiFlush();
+        ::SelectObject(mem_, old);
+
+        return Capture{ static_cast<const uint8_t*>(slot->bits), w, h, size_t(slot->w) * 4, slot };
+    }
 
-    HDC wndDC = ::GetDC(hwnd);
-    HDC memDC = ::CreateCompatibleDC(wndDC);
-    HBITMAP hbm = ::CreateCompatibleBitmap(wndDC,w,h);
-    ::SelectObject(memDC,hbm);
+    /* several client rectangles blitted into one strip, stacked top-down in
+       the given order; rectangles must already be clipped to the client.
+       Unlike grab() this BitBlts from the window DC. Under desktop
+       composition that DC reads the window's own surface, so overlapping
+       windows do not matter and its clip box is the whole client. Without
+       composition the clip box shrinks to the visible part (or turns
+       complex); then a covered rectangle would read the other window, so
+       nothing is returned and the caller grabs the full frame instead.    */
+    Capture grab(const std::vector<RECT>& rois)
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        int w = 0, h = 0;
+        for (const RECT& r : rois) {
+            w  = std::max<int>(w, r.right - r.left);
+            h += std::max<int>(0, r.bottom - r.top);
+        }
+        if (w <= 0 || h <= 0) return {};
+
+        HDC wnd = ::GetDC(hwnd_);
+        RECT clip{};
+        const int kind = ::GetClipBox(wnd, &clip);
+        for (const RECT& r : rois) {
+            if (r.right <= r.left || r.bottom <= r.top) continue;
+            if (kind != SIMPLEREGION || r.left < clip.left || r.top < clip.top
+                                     || r.right > clip.right || r.bottom > clip.bottom) {
+                LOG_DEBUG("[capture] roi (%ld,%ld,%ld,%ld) not fully visible\n",
+                          r.left, r.top, r.right, r.bottom);
+                ::ReleaseDC(hwnd_, wnd);
+                return {};
+            }
+        }
+
+        auto slot = acquire(strip_, w, h, false);
+        if (!slot) { ::ReleaseDC(hwnd_, wnd); return {}; }
+
+        HGDIOBJ old = ::SelectObject(mem_, slot->bmp);
+        int y = 0;
+        for (const RECT& r : rois) {
+            int rw = r.right - r.left, rh = r.bottom - r.top;
+            if (rw <= 0 || rh <= 0) continue;
+            ::BitBlt(mem_, 0, y, rw, rh, wnd, r.left, r.top, SRCCOPY);
+            y += rh;
+        }
+        ::GdiFlush();
+        ::SelectObject(mem_, old);
+        ::ReleaseDC(hwnd_, wnd);
+
+        return Capture{ static_cast<const uint8_t*>(slot->bits), w, h, size_t(slot->w) * 4, slot };
+    }
 
-    BOOL ok = ::PrintWindow(hwnd, memDC, PW_CLIENTONLY);
-    if(!ok){LOG_WARN("PrintWindow failed (%s), falling back to BitBlt\n",last_error().c_str());
-        POINT p{0,0}; ::ClientToScreen(hwnd,&p);
-        HDC scr = ::GetDC(nullptr);
-        ::BitBlt(memDC,0,0,w,h,scr,p.x,p.y,SRCCOPY|CAPTUREBLT);
-        ::ReleaseDC(nullptr,scr);
+private:
+    struct Slot {
+        HBITMAP bmp{};  void* bits{};  int w{}, h{};
+        ~Slot() { if (bmp) ::DeleteObject(bmp); }
+    };
+    using SlotPtr = std::shared_ptr<Slot>;
+    struct Ring { std::vector<SlotPtr> slots; size_t next = 0; };
+
+    SlotPtr make_slot(int w, int h)
+    {
+        BITMAPINFO bmi{}; bmi.bmiHeader.biSize=sizeof(BITMAPINFOHEADER); bmi.bmiHeader.biWidth=w; bmi.bmiHeader.biHeight=-h;
+        bmi.bmiHeader.biPlanes=1; bmi.bmiHeader.biBitCount=32; bmi.bmiHeader.biCompression=BI_RGB;
+        auto s = std::make_shared<Slot>();
+        s->bmp = ::CreateDIBSection(mem_, &bmi, DIB_RGB_COLORS, &s->bits, nullptr, 0);
+        if (!s->bmp || !s->bits) { LOG_ERROR("CreateDIBSection failed: %s\n", last_error().c_str()); return nullptr; }
+        s->w = w; s->h = h;
+        LOG_DEBUG("[capture] new DIB section %dx%d\n", w, h);
+        return s;
     }
 
-    /* extract bits */
-    BITMAPINFO bmi{}; bmi.bmiHeader.biSize=sizeof(BITMAPINFOHEADER); bmi.bmiHeader.biWidth=w; bmi.bmiHeader.biHeight=-h;
-    bmi.bmiHeader.biPlanes=1; bmi.bmiHeader.biBitCount=32; bmi.bmiHeader.biCompression=BI_RGB;
-    std::vector<uint8_t> buf(w*h*4);
-    if(!::GetDIBits(memDC,hbm,0,h,buf.data(),&bmi,DIB_RGB_COLORS)){
-        LOG_ERROR("GetDIBits failed: %s\n",last_error().c_str());
-        ::DeleteObject(hbm);::DeleteDC(memDC);::ReleaseDC(hwnd,wndDC);
-        return false;
+    /* free slot of the ring (use_count()==1 → nobody holds a lease).
+       `exact` slots are rebuilt on resize, strip slots only ever grow.     */
+    SlotPtr acquire(Ring& ring, int w, int h, bool exact)
+    {
+        const size_t n_slots = ring.slots.size();
+        for (size_t k = 0; k < n_slots; ++k) {
+            SlotPtr& s = ring.slots[(ring.next + k) % n_slots];
+            if (s.use_count() != 1) continue;
+            ring.next = (ring.next + k + 1) % n_slots;
+            bool fits = exact ? (s->w == w && s->h == h) : (s->w >= w && s->h >= h);
+            if (!fits) {
+                SlotPtr n = make_slot(exact ? w : std::max(w, s->w), exact ? h : std::max(h, s->h));
+                if (!n) return nullptr;
+                s = n;
+            }
+            return s;
+        }
+        SlotPtr n = make_slot(w, h);
+        if (!n) return nullptr;
+        if (n_slots < max_) ring.slots.push_back(n);        // else: one-shot, freed with its lease
+        else LOG_WARN("[capture] all %zu ring slots leased – using a one-shot buffer\n", n_slots);
+        return n;
     }
 
-    bool saved = detail::save_bitmap(buf.data(), w*4, w, h, file);
+    HWND                 hwnd_;
+    size_t               max_;
+    HDC                  mem_{};
+    Ring                 full_, strip_;
+    std::mutex           mu_;
+};
+
+/* one context per window, created on first use */
+inline CaptureContext& capture_context(HWND hwnd)
+{
+    static std::mutex mu;
+    static std::map<HWND, std::unique_ptr<CaptureContext>> ctxs;
+    std::lock_guard<std::mutex> lock(mu);
+    auto& c = ctxs[hwnd];
+    if (!c) c = std::make_unique<CaptureContext>(hwnd, CFG_INT("capture_ring_size", 4));
+    return *c;
+}
+
+/*──────────────────────────── PrintWindow capture ──────────────────────────*/
+inline bool capture_window(HWND hwnd,const std::filesystem::path& file)
+{
+    if(!::IsWindow(hwnd)){LOG_ERROR("capture_window: invalid HWND\n");return false;}
+    if(::IsIconic(hwnd)) ::ShowWindow(hwnd,SW_RESTORE);
+
+    Capture cap = capture_context(hwnd).grab();
+    if(!cap){LOG_ERROR("capture_window: capture failed\n");return false;}
 
-    ::DeleteObject(hbm); ::DeleteDC(memDC); ::ReleaseDC(hwnd,wndDC);
+    bool saved = detail::save_bitmap(cap.bits, cap.stride, cap.w, cap.h, file);
     if(!saved) LOG_ERROR("capture_window: save failed\n");
     return saved;
 }
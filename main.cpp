@@ -3,6 +3,55 @@
 #include "dwin_api.hpp"
 #include "dscreen_ocr.hpp"   // OCR wrapper we built
 #include "dproc.hpp"
+#include "drecord.hpp"
+#include <filesystem>
+#include <ctime>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <thread>
+#include <vector>
+
+/* one startup task, timed on its own thread.
+ * Steps may share singletons: those are function-local statics, whose first
+ * initialisation C++11 serialises (never build with -fno-threadsafe-statics),
+ * and cfg::Config reads behind its own mutex. The config itself (and the log
+ * level it sets) is loaded in main before the first step starts.          */
+struct Step {
+    const char*           name;
+    std::function<void()> fn;
+};
+
+static bool run_steps(const std::vector<Step>& steps)
+{
+    using clk = std::chrono::steady_clock;
+    const auto t0 = clk::now();
+    std::vector<double>             ms(steps.size());
+    std::vector<std::exception_ptr> err(steps.size());
+    std::vector<std::thread>        th;
+    for (size_t i = 0; i < steps.size(); ++i)
+        th.emplace_back([&, i] {
+            const auto s = clk::now();
+            try { steps[i].fn(); } catch (...) { err[i] = std::current_exception(); }
+            ms[i] = std::chrono::duration<double, std::milli>(clk::now() - s).count();
+        });
+    for (auto& t : th) t.join();
+
+    bool ok = true;
+    for (size_t i = 0; i < steps.size(); ++i) {
+        if (err[i]) {
+            ok = false;
+            try { std::rethrow_exception(err[i]); }
+            catch (const std::exception& e) { LOG_ERROR("startup %-12s failed: %s\n", steps[i].name, e.what()); }
+            catch (...)                     { LOG_ERROR("startup %-12s failed\n", steps[i].name); }
+        } else {
+            LOG_INFO("startup %-12s %8.1f ms\n", steps[i].name, ms[i]);
+        }
+    }
+    LOG_INFO("startup ready in %.1f ms\n",
+             std::chrono::duration<double, std::milli>(clk::now() - t0).count());
+    return ok;
+}
 
 int main() {
     SetConsoleOutputCP(CP_UTF8);
@@ -16,14 +65,30 @@ int main() {
     
     
     LOG_INFO("Starting...\n");
-    const char *temp_dir = CFG_STR("temp_dir", "./temp").c_str();
-    std::string window_label = CFG_STR("window", "......");
+    cfg::Config::get();                 // load .config before any startup thread reads it
+    const std::string temp_dir     = CFG_STR("temp_dir", "./temp");
+    const std::string window_label = CFG_STR("window", "......");
+    const std::string procedure    = CFG_STR("procedure_name", "......");
 
-    LOG_INFO("Cleaning temporal directory: %s...\n", temp_dir);
-    du::DeleteFilesInDirectory(temp_dir);
+    /* startup: independent steps side by side, so the first command finds
+       the OCR engines initialised and the procedures already read        */
+    HWND hwnd = nullptr;
+    std::vector<std::string> proc_errors;
+    std::vector<Step> steps = {
+        { "ocr engines", [] { so::warm_up(); } },
+        { "templates",   [] { so::Templates::get(); } },
+        { "window",      [&] { hwnd = dw::find_window_utf8(window_label, true); } },
+        { "temp dir",    [&] { du::DeleteFilesInDirectory(temp_dir.c_str()); } },
+        { "procedures",  [&] { proc_errors = dp::ProcCache::get().check(procedure); } },
+    };
+    if (!run_steps(steps)) return 1;
 
+    /* every parse error of the procedure tree now, not hours into a run */
+    if (!proc_errors.empty()) {
+        for (const std::string& e : proc_errors) LOG_ERROR("%s\n", e.c_str());
+        return 1;
+    }
 
-    HWND hwnd = dw::find_window_utf8(window_label, true);
     if (!hwnd) {
         LOG_ERROR("Window not found\n");
         return 1;
@@ -31,15 +96,47 @@ int main() {
 
     LOG_INFO("Hooked window: %s\n", dw::get_window_title(hwnd).c_str());
 
+    /* optional session recording (frames + commands + OCR in one file) */
+    if (CFG_BOOL("record_session", false)) {
+        std::string dir = CFG_STR("record_dir", "./recordings");
+        std::filesystem::create_directories(dir);
+        char name[64];
+        std::time_t now = std::time(nullptr);
+        std::strftime(name, sizeof name, "/session_%Y%m%d_%H%M%S.drec", std::localtime(&now));
+        dr::session().open(dir + name, CFG_INT("record_key_every", 120),
+                           CFG_INT("record_queue_frames", 4));
+    }
+
+    /* optional background capture, waits and diffs read its newest frame */
+    if (int fps = CFG_INT("capture_fps", 0); fps > 0)
+        so::CaptureThread::get().start(hwnd, fps);
+
     dp::Context ctx{.hwnd = hwnd};
 
-    dp::run_proc(ctx, CFG_STR("procedure_name", "......"));   // ← one-liner launch
+    /* a throwing proc still drains the results, closes the recording (with
+       its footer) and writes the queued debug images                      */
+    int rc = 0;
+    try {
+        dp::run_proc(ctx, procedure);   // ← one-liner launch
+    } catch (const std::exception& e) {
+        LOG_ERROR("procedure %s aborted: %s\n", procedure.c_str(), e.what());
+        rc = 1;
+    } catch (...) {
+        LOG_ERROR("procedure %s aborted\n", procedure.c_str());
+        rc = 1;
+    }
+
+    so::CaptureThread::get().stop();
+    ds::Sinks::get().close_all();               // drain + fsync the results files
+    dr::session().close();
+    so::detail::DebugWriter::get().flush();     // pending debug images
+    if (rc) return rc;
 
 
     /* claen the enviroment */
     if(CFG_BOOL("delete_temp", false)) {
-        LOG_INFO("Cleaning temporal directory: %s...\n", temp_dir);
-        du::DeleteFilesInDirectory(temp_dir);
+        LOG_INFO("Cleaning temporal directory: %s...\n", temp_dir.c_str());
+        du::DeleteFilesInDirectory(temp_dir.c_str());
     }
     
     return 0;
@@ -9,6 +9,8 @@ from pathlib import Path
 import pandas as pd
 import numpy as np
 
+from utils.file_utils import iter_records
+
 
 base_data_folder = '/src/data/objects/pure'
 excel_file = '/src/data/objects/objects_pure_update.xlsx'
@@ -18,13 +20,10 @@ def load_data_from_folder():
     folder = Path(base_data_folder)
     data = []
 
-    for json_file in folder.glob('*.json'):
-        with open(json_file, 'r', encoding='utf-8') as f:
-            raw = json.load(f)
-
-            # Clean up keys
-            clean_item = {k.strip('"'): v for k, v in raw.items()}
-            data.append(clean_item)
+    for _, raw in iter_records(folder):
+        # Clean up keys
+        clean_item = {k.strip('"'): v for k, v in raw.items()}
+        data.append(clean_item)
 
     # Create DataFrame
     df = pd.DataFrame(data)
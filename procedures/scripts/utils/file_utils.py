@@ -1,3 +1,4 @@
+import json
 import pandas as pd
 import locale
 from pathlib import Path
@@ -20,6 +21,36 @@ def load_data(path: Path) -> (pd.DataFrame, Path):
     return df, path
 
 
+def iter_records(folder: Path, with_path: bool = False):
+    """Yield (record_id, dict) for every saved item in *folder*, oldest first.
+
+    Reads both layouts the bot writes: one ``<id>.json`` per item
+    (results_sink=files) and ``results_*.jsonl`` run files, one object per
+    line with the id under ``_id`` (results_sink=jsonl). A torn last line
+    from an interrupted run is skipped. *with_path* adds the file the
+    record came from as a third item.
+    """
+    folder = Path(folder)
+    files = sorted(list(folder.glob("*.json")) + list(folder.glob("*.jsonl")),
+                   key=lambda p: p.stat().st_mtime)
+    for p in files:
+        if p.suffix == ".json":
+            try:
+                rec = json.loads(p.read_text("utf-8"))
+            except (OSError, ValueError):
+                continue
+            yield (p.stem, rec, p) if with_path else (p.stem, rec)
+            continue
+        with open(p, "r", encoding="utf-8") as f:
+            for line in f:
+                try:
+                    rec = json.loads(line)
+                except ValueError:
+                    continue
+                rid = rec.pop("_id", "")
+                yield (rid, rec, p) if with_path else (rid, rec)
+
+
 def save_data(df: pd.DataFrame, path: Path) -> None:
     ext = path.suffix.lower()
     if ext == '.xlsx':
@@ -34,6 +34,7 @@ from typing import List, Optional, Tuple
 import numpy as np
 import pandas as pd
 
+from utils.file_utils import iter_records
 from utils.query_utils import simplify
 
 # ---------------------------------------------------------------------------
@@ -121,23 +122,18 @@ def curate_price_json_files(folder: Path) -> None:
 
 
 def _json_folder_to_dataframe(folder: Path) -> pd.DataFrame:
-    """Read every *.json* in *folder* into a cleaned **DataFrame**."""
+    """Read every saved item in *folder* (*.json / *.jsonl) into a cleaned **DataFrame**."""
     records: list[dict] = []
-    for p in folder.glob("*.json"):
-        try:
-            raw = json.loads(p.read_text("utf‑8"))
-        except Exception as exc:
-            logger.error("Could not parse %s: %s", p, exc)
-            continue
-
+    for _, raw, src in iter_records(folder, with_path=True):
         rec = {
             "category": raw.get("category", "").strip(),
             "name": raw.get("name", "").strip(),
-            "pods": raw.get("pods", "").strip(),
+            "pods": str(raw.get("pods", "")).strip(),
             "avg_price": _clean_numeric_field(raw.get("avg_price", "")),
             "x1": _clean_numeric_field(raw.get("x1", "")),
             "x10": _clean_numeric_field(raw.get("x10", "")),
             "x100": _clean_numeric_field(raw.get("x100", "")),
+            "_jsonl": src.suffix == ".jsonl",
         }
         records.append(rec)
 
@@ -146,6 +142,11 @@ def _json_folder_to_dataframe(folder: Path) -> pd.DataFrame:
         return df
 
     df["name_key"] = df["name"].apply(simplify)
+    # a .jsonl run file appends every read of an item – the newest one wins
+    # (per-item .json files are curated by curate_price_json_files instead)
+    jsonl = df.pop("_jsonl")
+    dup = df[jsonl].duplicated("name_key", keep="last")
+    df = df.drop(dup[dup].index).reset_index(drop=True)
     numeric_cols = ["avg_price", "x1", "x10", "x100"]
     df[numeric_cols] = df[numeric_cols].astype(float)
     return df